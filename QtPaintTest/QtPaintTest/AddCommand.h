@@ -13,5 +13,4 @@ public:
 private:
     DrawingScene* myScene;
     StrokeItem* myItem;
-    bool firstExecution;
 };
\ No newline at end of file
@@ -0,0 +1,26 @@
+#include "AddFrameCommand.h"
+#include "MainWindow.h"
+
+// AddFrameCommand Implementation
+AddFrameCommand::AddFrameCommand(MainWindow* window, int index, DrawingScene* frame, QUndoCommand* parent)
+    : QUndoCommand(parent), myWindow(window), myIndex(index), myFrame(frame), myFrameInProject(false)
+{
+    setText(QString("Add Frame %1").arg(index + 1));
+}
+
+AddFrameCommand::~AddFrameCommand() {
+    // While undone the frame only belongs to this command
+    if (!myFrameInProject) {
+        delete myFrame;
+    }
+}
+
+void AddFrameCommand::undo() {
+    myWindow->takeFrame(myIndex);
+    myFrameInProject = false;
+}
+
+void AddFrameCommand::redo() {
+    myWindow->insertFrame(myIndex, myFrame);
+    myFrameInProject = true;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+#include <QtWidgets>
+#include "DrawingScene.h"
+
+class MainWindow;
+
+// Project level command, inserts a frame into the timeline
+class AddFrameCommand : public QUndoCommand {
+public:
+    AddFrameCommand(MainWindow* window, int index, DrawingScene* frame, QUndoCommand* parent = nullptr);
+    ~AddFrameCommand();
+    void undo() override;
+    void redo() override;
+private:
+    MainWindow* myWindow;
+    int myIndex;
+    DrawingScene* myFrame;
+    bool myFrameInProject;
+};
\ No newline at end of file
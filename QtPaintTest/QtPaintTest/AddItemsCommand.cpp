@@ -0,0 +1,33 @@
+#include "AddItemsCommand.h"
+
+// AddItemsCommand Implementation
+AddItemsCommand::AddItemsCommand(DrawingScene* scene, const QList<BaseItem*>& items, QUndoCommand* parent)
+    : QUndoCommand(parent), myScene(scene), myItems(items)
+{
+    for (BaseItem* item : myItems) item->retainHistory();
+    setText(QString("Add %1 Shapes").arg(items.size()));
+}
+
+AddItemsCommand::~AddItemsCommand() {
+    // While undone the items only belong to the history
+    for (BaseItem* item : myItems) item->releaseHistory();
+}
+
+void AddItemsCommand::undo() {
+    if (!myScene) return;
+
+    myScene->removeItems(myItems);
+    for (BaseItem* item : myItems) {
+        item->dehydrate();
+    }
+}
+
+void AddItemsCommand::redo() {
+    if (!myScene) return;
+
+    // The scene only repaints once all items are in
+    for (BaseItem* item : myItems) {
+        item->rehydrate();
+    }
+    myScene->addItems(myItems);
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+#include <QtWidgets>
+#include "DrawingScene.h"
+#include "BaseItem.h"
+
+// Adds a batch of items as a single undo step
+class AddItemsCommand : public QUndoCommand {
+public:
+    AddItemsCommand(DrawingScene* scene, const QList<BaseItem*>& items, QUndoCommand* parent = nullptr);
+    ~AddItemsCommand();
+    void undo() override;
+    void redo() override;
+private:
+    DrawingScene* myScene;
+    QList<BaseItem*> myItems;
+};
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "ApngWriter.h"
+#include <QtEndian>
+#include <array>
+#include <cstring>
+
+namespace {
+	const char PNG_SIGNATURE[8] = { '\x89', 'P', 'N', 'G', '\r', '\n', '\x1a', '\n' };
+
+	quint32 crc32(const QByteArray& data) {
+		static const std::array<quint32, 256> table = []() {
+			std::array<quint32, 256> result{};
+			for (quint32 n = 0; n < 256; n++) {
+				quint32 c = n;
+				for (int k = 0; k < 8; k++) {
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				}
+				result[n] = c;
+			}
+			return result;
+		}();
+
+		quint32 crc = 0xFFFFFFFFu;
+		for (char ch : data) {
+			crc = table[(crc ^ static_cast<quint8>(ch)) & 0xFF] ^ (crc >> 8);
+		}
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+	void appendUInt32(QByteArray& data, quint32 value) {
+		char buffer[4];
+		qToBigEndian(value, buffer);
+		data.append(buffer, 4);
+	}
+
+	void appendUInt16(QByteArray& data, quint16 value) {
+		char buffer[2];
+		qToBigEndian(value, buffer);
+		data.append(buffer, 2);
+	}
+
+	struct PngChunk {
+		QByteArray type;
+		QByteArray data;
+	};
+
+	// Split a PNG file into its chunks, skipping the signature
+	bool parsePng(const QByteArray& png, QList<PngChunk>& chunks) {
+		if (png.size() < 8 || memcmp(png.constData(), PNG_SIGNATURE, 8) != 0) {
+			return false;
+		}
+
+		qsizetype offset = 8;
+		while (offset + 12 <= png.size()) {
+			quint32 length = qFromBigEndian<quint32>(png.constData() + offset);
+			if (static_cast<quint64>(offset) + 12 + length > static_cast<quint64>(png.size())) {
+				return false;
+			}
+			chunks.append({ png.mid(offset + 4, 4), png.mid(offset + 8, length) });
+			offset += 12 + length;
+		}
+		return !chunks.isEmpty();
+	}
+}
+
+ApngWriter::ApngWriter(QIODevice* device, int frameCount, int frameRate)
+	: m_device(device), m_frameCount(frameCount), m_frameRate(qMax(1, frameRate)) {
+}
+
+bool ApngWriter::writeChunk(const char* type, const QByteArray& data) {
+	QByteArray chunk;
+	chunk.reserve(data.size() + 12);
+	appendUInt32(chunk, static_cast<quint32>(data.size()));
+	chunk.append(type, 4);
+	chunk.append(data);
+	appendUInt32(chunk, crc32(chunk.mid(4)));
+
+	if (m_device->write(chunk) != chunk.size()) {
+		m_error = m_device->errorString();
+		return false;
+	}
+	return true;
+}
+
+bool ApngWriter::addFrame(const QByteArray& pngData) {
+	if (isFinished()) {
+		m_error = "All frames have already been written";
+		return false;
+	}
+
+	QList<PngChunk> chunks;
+	if (!parsePng(pngData, chunks) || chunks.first().type != "IHDR") {
+		m_error = QString("Frame %1 is not a valid PNG image").arg(m_framesWritten);
+		return false;
+	}
+
+	const QByteArray& header = chunks.first().data;
+	if (m_framesWritten == 0) {
+		// File header: signature, the image header of the first frame and the animation control chunk
+		m_header = header;
+		if (m_device->write(PNG_SIGNATURE, 8) != 8) {
+			m_error = m_device->errorString();
+			return false;
+		}
+		if (!writeChunk("IHDR", m_header)) return false;
+
+		QByteArray animationControl;
+		appendUInt32(animationControl, static_cast<quint32>(m_frameCount));
+		appendUInt32(animationControl, 0); // Loop forever
+		if (!writeChunk("acTL", animationControl)) return false;
+	}
+	else if (header != m_header) {
+		m_error = QString("Frame %1 does not match the size or format of the first frame").arg(m_framesWritten);
+		return false;
+	}
+
+	// Frame control: full canvas, shown for one frame interval, replacing the previous frame
+	QByteArray frameControl;
+	appendUInt32(frameControl, m_sequence++);
+	frameControl.append(m_header.left(8)); // Width and height
+	appendUInt32(frameControl, 0);
+	appendUInt32(frameControl, 0);
+	appendUInt16(frameControl, 1);
+	appendUInt16(frameControl, static_cast<quint16>(m_frameRate));
+	frameControl.append('\0'); // APNG_DISPOSE_OP_NONE
+	frameControl.append('\0'); // APNG_BLEND_OP_SOURCE
+	if (!writeChunk("fcTL", frameControl)) return false;
+
+	for (const PngChunk& chunk : chunks) {
+		if (chunk.type != "IDAT") continue;
+
+		if (m_framesWritten == 0) {
+			// The first frame doubles as the default image
+			if (!writeChunk("IDAT", chunk.data)) return false;
+		}
+		else {
+			QByteArray frameData;
+			frameData.reserve(chunk.data.size() + 4);
+			appendUInt32(frameData, m_sequence++);
+			frameData.append(chunk.data);
+			if (!writeChunk("fdAT", frameData)) return false;
+		}
+	}
+
+	m_framesWritten++;
+	if (isFinished()) {
+		return writeChunk("IEND", QByteArray());
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+#include <QtCore>
+
+// Minimal animated PNG encoder. Frames are handed over as complete PNG files
+// (as written by QImage::save) and their image data is re-wrapped into APNG chunks.
+class ApngWriter {
+public:
+	ApngWriter(QIODevice* device, int frameCount, int frameRate);
+
+	bool addFrame(const QByteArray& pngData);
+	bool isFinished() const { return m_framesWritten == m_frameCount; }
+	QString errorString() const { return m_error; }
+
+private:
+	bool writeChunk(const char* type, const QByteArray& data);
+
+	QIODevice* m_device;
+	int m_frameCount;
+	int m_frameRate;
+	int m_framesWritten = 0;
+	quint32 m_sequence = 0;
+	QByteArray m_header; // IHDR of the first frame, every frame must match it
+	QString m_error;
+};
\ No newline at end of file
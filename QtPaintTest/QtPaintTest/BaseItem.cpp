@@ -5,4 +5,10 @@ BaseItem::BaseItem() : m_isSelected(false) {}
 void BaseItem::setSelected(bool selected) {
     m_isSelected = selected;
     update();
+}
+
+void BaseItem::releaseHistory() {
+    if (--m_historyRefs == 0 && !scene()) {
+        delete this;
+    }
 }
\ No newline at end of file
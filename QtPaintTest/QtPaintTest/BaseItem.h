@@ -11,7 +11,24 @@ public:
 
 	virtual BaseItem* clone() const = 0;
 
+	// Geometry goes through these so items can keep it in a more compact form
+	// than QGraphicsPathItem's own path, which stays the plain storage
+	virtual QPainterPath geometry() const { return path(); }
+	virtual void setGeometry(const QPainterPath& path) { setPath(path); }
+
+	// Called by commands when the item leaves or re-enters the scene, items
+	// with heavy geometry can hand it to the HistoryStore in the meantime
+	virtual void dehydrate() {}
+	virtual void rehydrate() {}
+
+	// Every undo command that refers to the item holds a reference. Whoever
+	// drops the last one while the item is outside a scene deletes it, an item
+	// in a scene belongs to that scene
+	void retainHistory() { m_historyRefs++; }
+	void releaseHistory();
+
 protected:
 	bool m_isSelected = false;
+	int m_historyRefs = 0;
 	// For the future, if layers are implemented, they should be handled here
 };
\ No newline at end of file
@@ -5,6 +5,10 @@ BaseTool::BaseTool() {
 	// Initialize other members if needed
 }
 
+void BaseTool::mouseMoveBatch(const QList<InputSample>& samples, QGraphicsSceneMouseEvent* event) {
+	mouseMoveEvent(event);
+}
+
 void BaseTool::keyPressEvent(QKeyEvent* event) {
 	// Default implementation does nothing
 }
@@ -6,6 +6,13 @@
 
 class DrawingScene;
 
+// One pointer position as it arrived, before it was coalesced with others
+struct InputSample {
+    QPointF scenePos;
+    qint64 timestamp = 0; // PerfMonitor::now() when the event came in
+    qreal pressure = 1.0;
+};
+
 class BaseTool : public QObject {
 
 public:
@@ -15,6 +22,10 @@ public:
     virtual void mousePressEvent(QGraphicsSceneMouseEvent* event) = 0;
     virtual void mouseMoveEvent(QGraphicsSceneMouseEvent* event) = 0;
     virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) = 0;
+    // Moves made while a button is held arrive once per display refresh, with
+    // every position since the last batch. event holds the latest state.
+    // By default only the latest position is passed on to mouseMoveEvent().
+    virtual void mouseMoveBatch(const QList<InputSample>& samples, QGraphicsSceneMouseEvent* event);
     virtual void keyPressEvent(QKeyEvent* event);
     virtual void keyReleaseEvent(QKeyEvent* event);
 
@@ -0,0 +1,243 @@
+#include "BooleanEngine.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+	// Clip geometry is kept this far around a cluster, in Clipper units
+	const int64_t CLUSTER_MARGIN = 2;
+
+	qint64 vertexCount(const Clipper2Lib::Paths64& paths) {
+		qint64 count = 0;
+		for (const Clipper2Lib::Path64& path : paths) {
+			count += static_cast<qint64>(path.size());
+		}
+		return count;
+	}
+
+	// Splits contours into groups whose bounds don't overlap, cutting along
+	// one axis and then the other until neither separates anything
+	void separate(std::vector<size_t> ids, const std::vector<Clipper2Lib::Rect64>& bounds, bool alongX, bool otherAxisFailed,
+		std::vector<std::vector<size_t>>& groups) {
+		auto low = [&](size_t id) { return alongX ? bounds[id].left : bounds[id].top; };
+		auto high = [&](size_t id) { return alongX ? bounds[id].right : bounds[id].bottom; };
+		std::sort(ids.begin(), ids.end(), [&](size_t a, size_t b) {
+			return low(a) != low(b) ? low(a) < low(b) : a < b;
+		});
+
+		std::vector<std::vector<size_t>> runs;
+		int64_t reach = 0;
+		for (size_t id : ids) {
+			if (runs.empty() || low(id) > reach) {
+				runs.emplace_back();
+				reach = high(id);
+			}
+			runs.back().push_back(id);
+			reach = std::max(reach, high(id));
+		}
+
+		if (runs.size() == 1) {
+			if (otherAxisFailed) {
+				std::sort(runs[0].begin(), runs[0].end()); // Input order inside a group
+				groups.push_back(std::move(runs[0]));
+			}
+			else {
+				separate(std::move(runs[0]), bounds, !alongX, true, groups);
+			}
+			return;
+		}
+		for (std::vector<size_t>& run : runs) {
+			separate(std::move(run), bounds, !alongX, false, groups);
+		}
+	}
+}
+
+QThreadPool& BooleanEngine::pool() {
+	// Kept apart from the global pool, waiting on it would also wait for image decoding
+	static QThreadPool instance;
+	return instance;
+}
+
+void BooleanEngine::run(const std::vector<std::function<void()>>& tasks, qint64 vertices) {
+	if (tasks.size() < 2 || vertices < PARALLEL_THRESHOLD) {
+		for (const std::function<void()>& task : tasks) {
+			task();
+		}
+		return;
+	}
+
+	QThreadPool& threads = pool();
+	for (const std::function<void()>& task : tasks) {
+		threads.start(task);
+	}
+	threads.waitForDone();
+}
+
+void BooleanEngine::subtract(std::vector<Subject>& subjects, const Clipper2Lib::Paths64& clip) {
+	if (subjects.empty()) return;
+
+	std::vector<Clipper2Lib::Rect64> bounds(subjects.size());
+	std::vector<qint64> sizes(subjects.size());
+	qint64 vertices = 0;
+	for (size_t i = 0; i < subjects.size(); i++) {
+		bounds[i] = Clipper2Lib::GetBounds(subjects[i].paths);
+		sizes[i] = vertexCount(subjects[i].paths);
+		vertices += sizes[i];
+	}
+
+	// Neighbours along the clip's longer side end up in the same cluster, so
+	// every cluster overlaps a short stretch of it
+	const Clipper2Lib::Rect64 clipBounds = Clipper2Lib::GetBounds(clip);
+	const bool alongX = clipBounds.Width() >= clipBounds.Height();
+	std::vector<size_t> order(subjects.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		const int64_t ka = alongX ? bounds[a].left + bounds[a].right : bounds[a].top + bounds[a].bottom;
+		const int64_t kb = alongX ? bounds[b].left + bounds[b].right : bounds[b].top + bounds[b].bottom;
+		return ka != kb ? ka < kb : a < b;
+	});
+
+	// Consecutive runs of about the same number of vertices
+	const int threads = qMax(1, pool().maxThreadCount());
+	const qint64 clusterCount = vertices < PARALLEL_THRESHOLD ? 1
+		: qMin<qint64>(static_cast<qint64>(subjects.size()), threads * CLUSTERS_PER_THREAD);
+	const qint64 target = qMax<qint64>(1, vertices / clusterCount);
+
+	std::vector<std::function<void()>> tasks;
+	size_t begin = 0;
+	while (begin < order.size()) {
+		size_t end = begin;
+		qint64 size = 0;
+		while (end < order.size() && (size < target || end == begin)) {
+			size += sizes[order[end++]];
+		}
+
+		tasks.push_back([&subjects, &order, &bounds, &clip, clipBounds, begin, end]() {
+			Clipper2Lib::Rect64 area = bounds[order[begin]];
+			for (size_t k = begin + 1; k < end; k++) {
+				const Clipper2Lib::Rect64& rect = bounds[order[k]];
+				area.left = std::min(area.left, rect.left);
+				area.top = std::min(area.top, rect.top);
+				area.right = std::max(area.right, rect.right);
+				area.bottom = std::max(area.bottom, rect.bottom);
+			}
+			area.left -= CLUSTER_MARGIN;
+			area.top -= CLUSTER_MARGIN;
+			area.right += CLUSTER_MARGIN;
+			area.bottom += CLUSTER_MARGIN;
+
+			// Outside the cluster the clip can't change any of its subjects
+			Clipper2Lib::Paths64 localClip;
+			const bool wholeClip = area.Contains(clipBounds);
+			if (!wholeClip) localClip = Clipper2Lib::RectClip(area, clip);
+
+			Clipper2Lib::ReuseableDataContainer64 prepared;
+			prepared.AddPaths(wholeClip ? clip : localClip, Clipper2Lib::PathType::Clip, false);
+			Clipper2Lib::Clipper64 clipper;
+			Clipper2Lib::PolyTree64 remaining;
+			for (size_t k = begin; k < end; k++) {
+				Subject& subject = subjects[order[k]];
+				clipper.Clear();
+				clipper.AddSubject(subject.paths);
+				clipper.AddReuseableData(prepared);
+				clipper.Execute(Clipper2Lib::ClipType::Difference, subject.fillRule, remaining);
+
+				subject.pieces.clear();
+				for (const auto& outline : remaining) {
+					appendPieces(*outline, subject.pieces);
+				}
+			}
+		});
+		begin = end;
+	}
+
+	run(tasks, vertices);
+}
+
+std::vector<Clipper2Lib::Paths64> BooleanEngine::unite(const std::vector<Clipper2Lib::Paths64>& sets) {
+	std::vector<Clipper2Lib::Paths64> solutions(sets.size());
+
+	qint64 vertices = 0;
+	for (const Clipper2Lib::Paths64& set : sets) {
+		vertices += vertexCount(set);
+	}
+	const bool split = vertices >= PARALLEL_THRESHOLD;
+	const qint64 target = qMax<qint64>(1, vertices / (qMax(1, pool().maxThreadCount()) * CLUSTERS_PER_THREAD));
+
+	// Groups of contours, small groups of a set packed together
+	struct Cluster {
+		size_t set;
+		std::vector<size_t> contours;
+		Clipper2Lib::Paths64 solution;
+	};
+	std::vector<Cluster> clusters;
+	for (size_t s = 0; s < sets.size(); s++) {
+		const Clipper2Lib::Paths64& set = sets[s];
+		if (set.empty()) continue;
+
+		std::vector<size_t> all(set.size());
+		std::iota(all.begin(), all.end(), 0);
+		std::vector<std::vector<size_t>> groups;
+		if (split) {
+			std::vector<Clipper2Lib::Rect64> bounds(set.size());
+			for (size_t i = 0; i < set.size(); i++) {
+				bounds[i] = Clipper2Lib::GetBounds(set[i]);
+			}
+			separate(std::move(all), bounds, true, false, groups);
+		}
+		else {
+			groups.push_back(std::move(all));
+		}
+
+		qint64 size = 0;
+		for (std::vector<size_t>& group : groups) {
+			if (clusters.empty() || clusters.back().set != s || size >= target) {
+				clusters.push_back({ s, {}, {} });
+				size = 0;
+			}
+			for (size_t contour : group) {
+				size += static_cast<qint64>(set[contour].size());
+			}
+			std::vector<size_t>& contours = clusters.back().contours;
+			contours.insert(contours.end(), group.begin(), group.end());
+		}
+	}
+
+	std::vector<std::function<void()>> tasks;
+	tasks.reserve(clusters.size());
+	for (Cluster& cluster : clusters) {
+		tasks.push_back([&cluster, &sets]() {
+			const Clipper2Lib::Paths64& set = sets[cluster.set];
+			Clipper2Lib::Paths64 subject;
+			subject.reserve(cluster.contours.size());
+			for (size_t contour : cluster.contours) {
+				subject.push_back(set[contour]);
+			}
+
+			Clipper2Lib::Clipper64 clipper;
+			clipper.PreserveCollinear(true);
+			clipper.AddSubject(subject);
+			clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, cluster.solution);
+		});
+	}
+	run(tasks, vertices);
+
+	// Clusters were made set by set, so each set's pieces come out in a fixed order
+	for (Cluster& cluster : clusters) {
+		Clipper2Lib::Paths64& solution = solutions[cluster.set];
+		solution.insert(solution.end(), std::make_move_iterator(cluster.solution.begin()), std::make_move_iterator(cluster.solution.end()));
+	}
+	return solutions;
+}
+
+void BooleanEngine::appendPieces(const Clipper2Lib::PolyPath64& outline, std::vector<Clipper2Lib::Paths64>& pieces) {
+	Clipper2Lib::Paths64 paths;
+	paths.reserve(outline.Count() + 1);
+	paths.push_back(outline.Polygon());
+	for (const auto& hole : outline) {
+		paths.push_back(hole->Polygon());
+		for (const auto& island : *hole) {
+			appendPieces(*island, pieces);
+		}
+	}
+	pieces.push_back(std::move(paths));
+}
\ No newline at end of file
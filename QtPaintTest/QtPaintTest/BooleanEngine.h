@@ -0,0 +1,43 @@
+#pragma once
+#include <QtWidgets>
+#include <clipper2/clipper.h>
+#include <functional>
+#include <vector>
+
+// Batches of Clipper booleans spread over a thread pool. Clipper64 itself is
+// single threaded, so a batch is split into clusters that don't depend on each
+// other and every cluster gets its own Clipper64. Results are stored in the
+// order the input was given, however the clusters were scheduled, so a batch
+// gives the same output from one run to the next.
+class BooleanEngine {
+public:
+	// Batches with fewer subject vertices run on the calling thread
+	static const int PARALLEL_THRESHOLD = 20000;
+	// Clusters per pool thread, a few so that uneven clusters still balance out
+	static const int CLUSTERS_PER_THREAD = 4;
+
+	struct Subject {
+		Clipper2Lib::Paths64 paths;
+		Clipper2Lib::FillRule fillRule = Clipper2Lib::FillRule::NonZero;
+		// Filled in by subtract(), one entry per separate piece that remains
+		std::vector<Clipper2Lib::Paths64> pieces;
+	};
+
+	// Subtracts clip from every subject. Subjects are clustered by where they
+	// lie, a cluster only subtracts the part of clip over it and prepares it
+	// once in its own ReuseableDataContainer64.
+	static void subtract(std::vector<Subject>& subjects, const Clipper2Lib::Paths64& clip);
+
+	// Unions every set on its own. Contours of a set whose bounds don't touch
+	// can't affect each other, so large sets are split and unioned in parallel.
+	static std::vector<Clipper2Lib::Paths64> unite(const std::vector<Clipper2Lib::Paths64>& sets);
+
+	// Every outline with its direct holes is one piece, islands inside a hole
+	// are pieces of their own
+	static void appendPieces(const Clipper2Lib::PolyPath64& outline, std::vector<Clipper2Lib::Paths64>& pieces);
+
+private:
+	static QThreadPool& pool();
+	// Runs every task, spread over the pool when there's enough work for it
+	static void run(const std::vector<std::function<void()>>& tasks, qint64 vertices);
+};
\ No newline at end of file
@@ -1,7 +1,8 @@
 #include "BrushTool.h"
 #include "DrawingScene.h"
 #include "DrawingManager.h"
-#include "AddCommand.h"
+#include "StrokeFinalizer.h"
+#include "PerfMonitor.h"
 
 BrushTool::BrushTool()
 	: m_cooldownInterval(100), m_tangentStrength(0.33) {
@@ -32,6 +33,25 @@ void BrushTool::mouseMoveEvent(QGraphicsSceneMouseEvent* event) {
 	updateBrushStroke(event->scenePos());
 	event->accept();
 }
+void BrushTool::mouseMoveBatch(const QList<InputSample>& samples, QGraphicsSceneMouseEvent* event) {
+	if (!m_currentPath) return;
+
+	if (m_variableWidth) {
+		for (const InputSample& sample : samples) {
+			addWidthSample(sample);
+		}
+		event->accept();
+		return;
+	}
+
+	// Every point is kept for the curve fit, the preview is rebuilt once
+	m_points.reserve(m_points.size() + samples.size());
+	for (const InputSample& sample : samples) {
+		m_points << sample.scenePos;
+	}
+	updateTemporaryPath(m_tempPathItem);
+	event->accept();
+}
 void BrushTool::mouseReleaseEvent(QGraphicsSceneMouseEvent* event) {
 	// Finalize the brush stroke
 	finalizeBrushStroke();
@@ -66,7 +86,7 @@ void BrushTool::commitSegment(StrokeItem* pathItem, QGraphicsPathItem* tempItem,
 
 	// Add cubic curve to the path
 	realPath.cubicTo(c1, c2, end);
-	pathItem->setPath(realPath);
+	pathItem->setGeometry(realPath);
 
 	// Keep only the last point for the next segment
 	m_points = { end };
@@ -91,9 +111,9 @@ QVector2D BrushTool::calculateTangent(int startIndex, int count) {
 
 	return avgDirection.normalized();
 }
-void BrushTool::optimizePath(QPainterPath& path, StrokeItem* pathItem) {
+QPainterPath BrushTool::optimizePath(const QPainterPath& path, qreal width) {
 	// Skip optimization if there aren't enough points
-	if (path.elementCount() < 4) return;
+	if (path.elementCount() < 4) return path;
 
 	QPainterPath newPath;
 	const QPainterPath::Element& firstEl = path.elementAt(0);
@@ -114,8 +134,8 @@ void BrushTool::optimizePath(QPainterPath& path, StrokeItem* pathItem) {
 	}
 
 	// Adaptive threshold based on brush width and segment density
-	qreal avgSegmentLength = segments > 0 ? totalLength / segments : DrawingManager::getInstance().getWidth() * 3;
-	qreal simplifyThreshold = qMin(DrawingManager::getInstance().getWidth() * 0.75, avgSegmentLength * 0.3);
+	qreal avgSegmentLength = segments > 0 ? totalLength / segments : width * 3;
+	qreal simplifyThreshold = qMin(width * 0.75, avgSegmentLength * 0.3);
 
 	// Process each cubic segment
 	for (int i = 1; i < path.elementCount(); i += 3) {
@@ -141,7 +161,7 @@ void BrushTool::optimizePath(QPainterPath& path, StrokeItem* pathItem) {
 		qreal deviation = QLineF(bezierMidPoint, lineMidPoint).length();
 
 		// Decision logic based on curve characteristics
-		if (deviation < simplifyThreshold && segmentLength < DrawingManager::getInstance().getWidth() * 3) {
+		if (deviation < simplifyThreshold && segmentLength < width * 3) {
 			// Nearly straight segment, use quadratic curve or line
 			if (deviation < simplifyThreshold * 0.3) {
 				newPath.lineTo(end); // Very straight, just use line
@@ -165,8 +185,7 @@ void BrushTool::optimizePath(QPainterPath& path, StrokeItem* pathItem) {
 		lastPoint = end;
 	}
 
-	path = newPath;
-	pathItem->setPath(path);
+	return newPath;
 }
 void BrushTool::updateTemporaryPath(QGraphicsPathItem* tempItem) {
 	if (!tempItem) return;
@@ -184,9 +203,21 @@ void BrushTool::updateTemporaryPath(QGraphicsPathItem* tempItem) {
 
 void BrushTool::startBrushStroke(const QPointF& pos) {
 	// Create the real path item
-	m_currentPath = new StrokeItem(DrawingManager::getInstance().getColor(), DrawingManager::getInstance().getWidth());
+	m_currentPath = new StrokeItem(DrawingManager::getInstance().getColor(), DrawingManager::getInstance().getWidth(),
+		StrokeStyleTable::forScene(DrawingManager::getInstance().getScene()));
 	DrawingManager::getInstance().getScene() -> addItem(m_currentPath);
 
+	// With pressure or speed in play the item builds its outline as the samples
+	// come in, there's no centerline to fit
+	m_variableWidth = DrawingManager::getInstance().hasPressure() || DrawingManager::getInstance().isVelocitySensitive();
+	if (m_variableWidth) {
+		m_points.clear();
+		m_velocityFactor = 1.0;
+		m_lastSample = { pos, PerfMonitor::getInstance().now(), DrawingManager::getInstance().currentPressure() };
+		m_currentPath->addWidthSample(pos, sampleWidth(m_lastSample));
+		return;
+	}
+
 	// Create the temporary path item for visual feedback
 	m_tempPathItem = new QGraphicsPathItem();
 	QPen tempPen(DrawingManager::getInstance().getColor(), DrawingManager::getInstance().getWidth());
@@ -199,7 +230,7 @@ void BrushTool::startBrushStroke(const QPointF& pos) {
 	m_points << pos;
 	m_realPath = QPainterPath();
 	m_realPath.moveTo(pos);
-	m_currentPath->setPath(m_realPath);
+	m_currentPath->setGeometry(m_realPath);
 
 	// Start the cooldown timer
 	m_cooldownTimer.start();
@@ -207,37 +238,62 @@ void BrushTool::startBrushStroke(const QPointF& pos) {
 void BrushTool::updateBrushStroke(const QPointF& pos) {
 	if (!m_currentPath) return;
 
+	if (m_variableWidth) {
+		addWidthSample({ pos, PerfMonitor::getInstance().now(), DrawingManager::getInstance().currentPressure() });
+		return;
+	}
+
 	m_points << pos;
 	updateTemporaryPath(m_tempPathItem);
 }
+void BrushTool::addWidthSample(const InputSample& sample) {
+	const qreal width = sampleWidth(sample);
+	m_currentPath->addWidthSample(sample.scenePos, width);
+	m_lastSample = sample;
+}
+qreal BrushTool::sampleWidth(const InputSample& sample) {
+	DrawingManager& manager = DrawingManager::getInstance();
+	qreal factor = manager.hasPressure() ? PRESSURE_MIN_WIDTH + (1 - PRESSURE_MIN_WIDTH) * sample.pressure : 1.0;
+
+	if (manager.isVelocitySensitive() && sample.timestamp > m_lastSample.timestamp) {
+		// Scene units per millisecond, eased in so the width doesn't jitter with the event rate
+		const qreal elapsed = (sample.timestamp - m_lastSample.timestamp) / 1e6;
+		const qreal speed = QLineF(m_lastSample.scenePos, sample.scenePos).length() / qMax<qreal>(elapsed, 0.5);
+		const qreal target = qMax(VELOCITY_MIN_WIDTH, 1 / (1 + VELOCITY_THINNING * speed));
+		m_velocityFactor += (target - m_velocityFactor) * VELOCITY_SMOOTHING;
+	}
+	return manager.getWidth() * factor * m_velocityFactor;
+}
 void BrushTool::finalizeBrushStroke() {
 	// Stop the timer
 	m_cooldownTimer.stop();
 
 	if (!m_currentPath) return;
 
-	// Commit any remaining points
-	if (m_points.size() > 1) {
-		commitSegment(m_currentPath, m_tempPathItem, m_realPath);
-	}
-	else if (m_points.size() == 1 && m_realPath.elementCount() <= 1) {
-		// For single clicks, create a circle
-		QPainterPath circlePath;
-		circlePath.addEllipse(m_points.first(), DrawingManager::getInstance().getWidth() / 2, DrawingManager::getInstance().getWidth() / 2);
-		m_currentPath->setPath(circlePath);
+	StrokeFinalizer::OutlineTask task;
+	if (m_variableWidth) {
+		// The outline was built while drawing, a single click left a dot
+		task = m_currentPath->outlineTask();
 	}
+	else {
+		// Commit any remaining points
+		bool isDot = false;
+		if (m_points.size() > 1) {
+			commitSegment(m_currentPath, m_tempPathItem, m_realPath);
+		}
+		else if (m_points.size() == 1 && m_realPath.elementCount() <= 1) {
+			// For single clicks, create a circle
+			QPainterPath circlePath;
+			circlePath.addEllipse(m_points.first(), DrawingManager::getInstance().getWidth() / 2, DrawingManager::getInstance().getWidth() / 2);
+			m_currentPath->setGeometry(circlePath);
+			isDot = true;
+		}
 
-	// Perform final path optimization
-	optimizePath(m_realPath, m_currentPath);
-
-	// Convert to filled path
-	m_currentPath->convertToFilledPath();
-
-	// Remove from scene before creating command
-	DrawingManager::getInstance().getScene()->removeItem(m_currentPath);
-
-	// Create a command to add the path to the scene
-	AddCommand* cmd = new AddCommand(DrawingManager::getInstance().getScene(), m_currentPath);
+		// Path optimization and the conversion to a filled path run on a worker
+		task = [path = m_currentPath->geometry(), width = m_currentPath->width(), isDot]() {
+			return StrokeItem::filledOutline(isDot ? path : optimizePath(path, width), width);
+		};
+	}
 
 	// Clean up
 	if (m_tempPathItem) {
@@ -246,12 +302,10 @@ void BrushTool::finalizeBrushStroke() {
 		m_tempPathItem = nullptr;
 	}
 
-	// Store and reset state before pusing command
-	StrokeItem* itemToAdd = m_currentPath;
+	// The stroke stays on screen as drawn, the finalizer swaps its outline in
+	// and pushes its command. The next stroke can start right away.
+	StrokeFinalizer::getInstance().submit(m_currentPath, DrawingManager::getInstance().getScene(), std::move(task));
 	m_currentPath = nullptr;
 	m_points.clear();
-
-	// Push the command to the undo stack
-	DrawingManager::getInstance().pushCommand(cmd);
 }
 
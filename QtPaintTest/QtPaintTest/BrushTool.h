@@ -12,6 +12,7 @@ public:
 
 	void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
 	void mouseMoveEvent(QGraphicsSceneMouseEvent* event) override;
+	void mouseMoveBatch(const QList<InputSample>& samples, QGraphicsSceneMouseEvent* event) override;
 	void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) override;
 	void keyPressEvent(QKeyEvent* event) override;
 	void keyReleaseEvent(QKeyEvent* event) override;
@@ -25,7 +26,8 @@ private slots:
 private:
 	void commitSegment(StrokeItem* pathItem, QGraphicsPathItem* tempItem, QPainterPath& realPath);
 	QVector2D calculateTangent(int startIndex, int count);
-	void optimizePath(QPainterPath& path, StrokeItem* pathItem);
+	// Pure path math, runs on the StrokeFinalizer's workers
+	static QPainterPath optimizePath(const QPainterPath& path, qreal width);
 	void updateTemporaryPath(QGraphicsPathItem* tempItem);
 
 	// Brush Implementation
@@ -33,6 +35,10 @@ private:
 	void updateBrushStroke(const QPointF& pos);
 	void finalizeBrushStroke();
 
+	// Variable width, for strokes drawn with pressure or speed
+	void addWidthSample(const InputSample& sample);
+	qreal sampleWidth(const InputSample& sample);
+
 
 	StrokeItem* m_currentPath = nullptr;
 	QGraphicsPathItem* m_tempPathItem = nullptr;
@@ -40,6 +46,10 @@ private:
 
 	QVector<QPointF> m_points;
 
+	bool m_variableWidth = false;
+	InputSample m_lastSample;
+	qreal m_velocityFactor = 1.0;
+
 	// Curve optimization parameters
 	QTimer m_cooldownTimer;
 	int m_cooldownInterval;
@@ -1,9 +1,7 @@
 #pragma once
 #include <QtWidgets>
+#include "StrokeItem.h"
 
-struct ClipboardItem {
-    QPainterPath path = QPainterPath();
-    QColor color = Qt::black;
-    qreal width = 1.0;
-    bool outlined = false;
-};
\ No newline at end of file
+// The clipboard keeps records of the copied strokes, their geometry stays
+// shared with the items it came from
+using ClipboardItem = StrokeRecord;
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include "CompactPath.h"
+#include "ScratchArena.h"
+#include <cstring>
+#include <limits>
+
+namespace {
+	void appendVarint(QByteArray& data, quint32 value) {
+		while (value >= 0x80) {
+			data.append(static_cast<char>((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		data.append(static_cast<char>(value));
+	}
+
+	quint32 readVarint(const uchar*& data) {
+		quint32 value = 0;
+		int shift = 0;
+		while (*data & 0x80) {
+			value |= static_cast<quint32>(*data++ & 0x7f) << shift;
+			shift += 7;
+		}
+		return value | (static_cast<quint32>(*data++) << shift);
+	}
+
+	quint32 zigzag(qint32 value) {
+		return (static_cast<quint32>(value) << 1) ^ static_cast<quint32>(value >> 31);
+	}
+
+	qint32 unzigzag(quint32 value) {
+		return static_cast<qint32>((value >> 1) ^ (0u - (value & 1)));
+	}
+
+	void appendInt32(QByteArray& data, qint32 value) {
+		data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	qint32 readInt32(const uchar*& data) {
+		qint32 value;
+		memcpy(&value, data, sizeof(value));
+		data += sizeof(value);
+		return value;
+	}
+}
+
+CompactPath CompactPath::fromPath(const QPainterPath& path, Encoding encoding) {
+	ScratchArena arena;
+	std::pmr::vector<Point> points = arena.vector<Point>(path.elementCount());
+	std::pmr::vector<int> contourSizes = arena.vector<int>();
+
+	for (int i = 0; i < path.elementCount(); i++) {
+		const QPainterPath::Element& element = path.elementAt(i);
+		if (element.isCurveTo() || element.type == QPainterPath::CurveToDataElement) {
+			return CompactPath();
+		}
+		if (element.isMoveTo() || contourSizes.empty()) {
+			contourSizes.push_back(0);
+		}
+		points.push_back({ qRound64(element.x * CLIPPER_SCALING), qRound64(element.y * CLIPPER_SCALING) });
+		contourSizes.back()++;
+	}
+	return encode(points.data(), contourSizes.data(), static_cast<int>(contourSizes.size()), path.fillRule(), encoding);
+}
+
+CompactPath CompactPath::fromClipper(const Clipper2Lib::Paths64& paths, Qt::FillRule fillRule, Encoding encoding) {
+	size_t total = 0;
+	for (const Clipper2Lib::Path64& path : paths) total += path.size() + 1;
+
+	ScratchArena arena;
+	std::pmr::vector<Point> points = arena.vector<Point>(total);
+	std::pmr::vector<int> contourSizes = arena.vector<int>(paths.size());
+
+	for (const Clipper2Lib::Path64& path : paths) {
+		if (path.empty()) continue;
+
+		for (const Clipper2Lib::Point64& point : path) {
+			points.push_back({ point.x, point.y });
+		}
+		// Same closing point convertSingleClipperPath adds
+		if (path.size() > 2) {
+			points.push_back({ path.front().x, path.front().y });
+		}
+		contourSizes.push_back(static_cast<int>(path.size() > 2 ? path.size() + 1 : path.size()));
+	}
+	return encode(points.data(), contourSizes.data(), static_cast<int>(contourSizes.size()), fillRule, encoding);
+}
+
+CompactPath CompactPath::encode(const Point* points, const int* contourSizes, int contourCount,
+	Qt::FillRule fillRule, Encoding encoding) {
+	qint64 minX = std::numeric_limits<qint64>::max(), minY = minX;
+	qint64 maxX = std::numeric_limits<qint64>::min(), maxY = maxX;
+	qint64 pointCount = 0;
+	for (int contour = 0; contour < contourCount; contour++) {
+		pointCount += contourSizes[contour];
+	}
+	for (qint64 i = 0; i < pointCount; i++) {
+		minX = qMin(minX, points[i].x);
+		minY = qMin(minY, points[i].y);
+		maxX = qMax(maxX, points[i].x);
+		maxY = qMax(maxY, points[i].y);
+	}
+
+	const qint64 limit = std::numeric_limits<qint32>::max();
+	if (pointCount == 0 || pointCount > limit || maxX - minX > limit || maxY - minY > limit) {
+		return CompactPath();
+	}
+
+	CompactPath result;
+	result.m_originX = minX;
+	result.m_originY = minY;
+	result.m_extentX = static_cast<qint32>(maxX - minX);
+	result.m_extentY = static_cast<qint32>(maxY - minY);
+	result.m_pointCount = static_cast<int>(pointCount);
+	result.m_contourCount = contourCount;
+	result.m_encoding = encoding;
+	result.m_fillRule = fillRule;
+
+	QByteArray& data = result.m_data;
+	if (encoding == Encoding::Raw) {
+		data.reserve(contourCount * 4 + pointCount * 8);
+		for (int contour = 0; contour < contourCount; contour++) {
+			appendInt32(data, contourSizes[contour]);
+		}
+		for (qint64 i = 0; i < pointCount; i++) {
+			appendInt32(data, static_cast<qint32>(points[i].x - minX));
+			appendInt32(data, static_cast<qint32>(points[i].y - minY));
+		}
+	}
+	else {
+		data.reserve(contourCount + pointCount * 4);
+		for (int contour = 0; contour < contourCount; contour++) {
+			appendVarint(data, static_cast<quint32>(contourSizes[contour]));
+		}
+		qint32 lastX = 0, lastY = 0;
+		for (qint64 i = 0; i < pointCount; i++) {
+			const qint32 x = static_cast<qint32>(points[i].x - minX);
+			const qint32 y = static_cast<qint32>(points[i].y - minY);
+			appendVarint(data, zigzag(x - lastX));
+			appendVarint(data, zigzag(y - lastY));
+			lastX = x;
+			lastY = y;
+		}
+	}
+	data.squeeze();
+	return result;
+}
+
+template<typename Visitor>
+void CompactPath::decode(Visitor&& visit) const {
+	const uchar* counts = reinterpret_cast<const uchar*>(m_data.constData());
+
+	// Points follow the contour sizes, for Raw they're at a known offset
+	const uchar* points = counts + m_contourCount * 4;
+	if (m_encoding == Encoding::Delta) {
+		points = counts;
+		for (int i = 0; i < m_contourCount; i++) readVarint(points);
+	}
+
+	qint32 x = 0, y = 0;
+	for (int contour = 0; contour < m_contourCount; contour++) {
+		const qint32 size = m_encoding == Encoding::Raw ? readInt32(counts) : static_cast<qint32>(readVarint(counts));
+		for (qint32 i = 0; i < size; i++) {
+			if (m_encoding == Encoding::Raw) {
+				x = readInt32(points);
+				y = readInt32(points);
+			}
+			else {
+				x += unzigzag(readVarint(points));
+				y += unzigzag(readVarint(points));
+			}
+			visit(i == 0, x, y);
+		}
+	}
+}
+
+QRectF CompactPath::boundingRect() const {
+	if (isNull()) return QRectF();
+	return QRectF(m_originX / CLIPPER_SCALING, m_originY / CLIPPER_SCALING,
+		m_extentX / CLIPPER_SCALING, m_extentY / CLIPPER_SCALING);
+}
+
+QPainterPath CompactPath::toPath() const {
+	QPainterPath path;
+	path.reserve(m_pointCount);
+	appendTo(path);
+	return path;
+}
+
+void CompactPath::appendTo(QPainterPath& path) const {
+	path.setFillRule(m_fillRule);
+	decode([&](bool startsContour, qint32 x, qint32 y) {
+		const qreal sceneX = (m_originX + x) / CLIPPER_SCALING;
+		const qreal sceneY = (m_originY + y) / CLIPPER_SCALING;
+		if (startsContour) {
+			path.moveTo(sceneX, sceneY);
+		}
+		else {
+			path.lineTo(sceneX, sceneY);
+		}
+	});
+}
+
+Clipper2Lib::Paths64 CompactPath::toClipper(qint64 offsetX, qint64 offsetY) const {
+	Clipper2Lib::Paths64 paths;
+	toClipper(paths, offsetX, offsetY);
+	return paths;
+}
+
+void CompactPath::toClipper(Clipper2Lib::Paths64& paths, qint64 offsetX, qint64 offsetY) const {
+	// Inner vectors are cleared rather than dropped, their capacity is reused
+	paths.resize(m_contourCount);
+	for (Clipper2Lib::Path64& path : paths) path.clear();
+
+	const qint64 baseX = m_originX + offsetX;
+	const qint64 baseY = m_originY + offsetY;
+	int contour = -1;
+	decode([&](bool startsContour, qint32 x, qint32 y) {
+		if (startsContour) contour++;
+		paths[contour].emplace_back(baseX + x, baseY + y);
+	});
+}
+
+QDataStream& operator<<(QDataStream& stream, const CompactPath& path) {
+	stream << path.m_data << path.m_originX << path.m_originY << path.m_extentX << path.m_extentY
+		<< qint32(path.m_pointCount) << qint32(path.m_contourCount)
+		<< quint8(path.m_encoding) << quint8(path.m_fillRule);
+	return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, CompactPath& path) {
+	qint32 pointCount, contourCount;
+	quint8 encoding, fillRule;
+	stream >> path.m_data >> path.m_originX >> path.m_originY >> path.m_extentX >> path.m_extentY
+		>> pointCount >> contourCount >> encoding >> fillRule;
+	if (stream.status() != QDataStream::Ok) {
+		path = CompactPath();
+		return stream;
+	}
+	path.m_pointCount = pointCount;
+	path.m_contourCount = contourCount;
+	path.m_encoding = static_cast<CompactPath::Encoding>(encoding);
+	path.m_fillRule = static_cast<Qt::FillRule>(fillRule);
+	return stream;
+}
\ No newline at end of file
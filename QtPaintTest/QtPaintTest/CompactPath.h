@@ -0,0 +1,66 @@
+#pragma once
+#include <QtWidgets>
+#include <clipper2/clipper.h>
+#include "DrawingEngineUtils.h"
+
+// Polygon geometry quantized to 1 / CLIPPER_SCALING and kept as 32-bit
+// offsets from the bounding box corner, optionally delta encoded. The data
+// is implicitly shared, so copies are cheap. Finalized strokes are polygons
+// only, this takes a fraction of the memory of a QPainterPath.
+class CompactPath {
+public:
+	enum class Encoding : quint8 {
+		Raw,  // 8 bytes per point, fastest to decode
+		Delta // Zigzag varint differences, usually 2 to 4 bytes per point
+	};
+
+	CompactPath() = default;
+
+	// Null if the path has curves or is too large to quantize
+	static CompactPath fromPath(const QPainterPath& path, Encoding encoding = Encoding::Delta);
+	// Clipper output in CLIPPER_SCALING units, each contour is closed
+	static CompactPath fromClipper(const Clipper2Lib::Paths64& paths, Qt::FillRule fillRule = Qt::OddEvenFill,
+		Encoding encoding = Encoding::Delta);
+
+	bool isNull() const { return m_pointCount == 0; }
+	int pointCount() const { return m_pointCount; }
+	int contourCount() const { return m_contourCount; }
+	Encoding encoding() const { return m_encoding; }
+	Qt::FillRule fillRule() const { return m_fillRule; }
+	QRectF boundingRect() const;
+	qsizetype memoryUsage() const { return sizeof(CompactPath) + m_data.capacity(); }
+
+	QPainterPath toPath() const;
+	void appendTo(QPainterPath& path) const; // Lets painting reuse one path's storage
+
+	// The stored coordinates already are Clipper coordinates, the offset is in the same units
+	Clipper2Lib::Paths64 toClipper(qint64 offsetX = 0, qint64 offsetY = 0) const;
+	// Same, reusing the vectors already in paths
+	void toClipper(Clipper2Lib::Paths64& paths, qint64 offsetX = 0, qint64 offsetY = 0) const;
+
+	// The encoded data as it is, for the HistoryStore
+	friend QDataStream& operator<<(QDataStream& stream, const CompactPath& path);
+	friend QDataStream& operator>>(QDataStream& stream, CompactPath& path);
+
+private:
+	struct Point {
+		qint64 x;
+		qint64 y;
+	};
+	static CompactPath encode(const Point* points, const int* contourSizes, int contourCount,
+		Qt::FillRule fillRule, Encoding encoding);
+
+	// Calls visit(startsContour, x, y) for every point, relative to the origin
+	template<typename Visitor>
+	void decode(Visitor&& visit) const;
+
+	QByteArray m_data;
+	qint64 m_originX = 0;
+	qint64 m_originY = 0;
+	qint32 m_extentX = 0;
+	qint32 m_extentY = 0;
+	int m_pointCount = 0;
+	int m_contourCount = 0;
+	Encoding m_encoding = Encoding::Raw;
+	Qt::FillRule m_fillRule = Qt::OddEvenFill;
+};
\ No newline at end of file
@@ -1,37 +1,242 @@
 #include "DrawingEngineUtils.h"
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// SSE2 is part of every x86-64 CPU, AVX2 is used when the CPU has it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DRAWING_SIMD_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#define DRAWING_SIMD_AVX2 1
+#define DRAWING_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#elif defined(__GNUC__)
+#define DRAWING_SIMD_AVX2 1
+#define DRAWING_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+#endif
+
+namespace {
+    // Doubles in [-2^51, 2^51] added to this end up with their value rounded
+    // to the nearest integer in the low mantissa bits, which turns the
+    // conversion into an add and an integer subtract. Coordinates are far
+    // inside that range.
+    const double ROUNDING_MAGIC = 6755399441055744.0; // 2^52 + 2^51
+
+    int64_t magicBits() {
+        int64_t bits;
+        std::memcpy(&bits, &ROUNDING_MAGIC, sizeof(bits));
+        return bits;
+    }
+
+    void toClipperScalar(const double* in, int64_t* out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = static_cast<int64_t>(std::nearbyint(in[i] * CLIPPER_SCALING));
+        }
+    }
+
+    void fromClipperScalar(const int64_t* in, double* out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = static_cast<double>(in[i]) / CLIPPER_SCALING;
+        }
+    }
+
+#if DRAWING_SIMD_SSE2
+    void toClipperSse2(const double* in, int64_t* out, size_t count) {
+        const __m128d scale = _mm_set1_pd(CLIPPER_SCALING);
+        const __m128d magic = _mm_set1_pd(ROUNDING_MAGIC);
+        const __m128i magicInt = _mm_set1_epi64x(magicBits());
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            const __m128d shifted = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(in + i), scale), magic);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi64(_mm_castpd_si128(shifted), magicInt));
+        }
+        toClipperScalar(in + i, out + i, count - i);
+    }
+
+    void fromClipperSse2(const int64_t* in, double* out, size_t count) {
+        const __m128d scale = _mm_set1_pd(CLIPPER_SCALING);
+        const __m128d magic = _mm_set1_pd(ROUNDING_MAGIC);
+        const __m128i magicInt = _mm_set1_epi64x(magicBits());
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            const __m128i shifted = _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), magicInt);
+            _mm_storeu_pd(out + i, _mm_div_pd(_mm_sub_pd(_mm_castsi128_pd(shifted), magic), scale));
+        }
+        fromClipperScalar(in + i, out + i, count - i);
+    }
+#endif
+
+#if DRAWING_SIMD_AVX2
+    DRAWING_TARGET_AVX2 void toClipperAvx2(const double* in, int64_t* out, size_t count) {
+        const __m256d scale = _mm256_set1_pd(CLIPPER_SCALING);
+        const __m256d magic = _mm256_set1_pd(ROUNDING_MAGIC);
+        const __m256i magicInt = _mm256_set1_epi64x(magicBits());
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m256d shifted = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(in + i), scale), magic);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi64(_mm256_castpd_si256(shifted), magicInt));
+        }
+        toClipperSse2(in + i, out + i, count - i);
+    }
+
+    DRAWING_TARGET_AVX2 void fromClipperAvx2(const int64_t* in, double* out, size_t count) {
+        const __m256d scale = _mm256_set1_pd(CLIPPER_SCALING);
+        const __m256d magic = _mm256_set1_pd(ROUNDING_MAGIC);
+        const __m256i magicInt = _mm256_set1_epi64x(magicBits());
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m256i shifted = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), magicInt);
+            _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_sub_pd(_mm256_castsi256_pd(shifted), magic), scale));
+        }
+        fromClipperSse2(in + i, out + i, count - i);
+    }
+
+    bool hasAvx2() {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        // AVX needs the OS to save the YMM registers
+        const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5));
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    using ToClipperKernel = void (*)(const double*, int64_t*, size_t);
+    using FromClipperKernel = void (*)(const int64_t*, double*, size_t);
+
+    // Picked once, the first time a conversion runs
+    ToClipperKernel toClipperKernel() {
+#if DRAWING_SIMD_AVX2
+        static const ToClipperKernel kernel = hasAvx2() ? toClipperAvx2 : toClipperSse2;
+        return kernel;
+#elif DRAWING_SIMD_SSE2
+        return toClipperSse2;
+#else
+        return toClipperScalar;
+#endif
+    }
+
+    FromClipperKernel fromClipperKernel() {
+#if DRAWING_SIMD_AVX2
+        static const FromClipperKernel kernel = hasAvx2() ? fromClipperAvx2 : fromClipperSse2;
+        return kernel;
+#elif DRAWING_SIMD_SSE2
+        return fromClipperSse2;
+#else
+        return fromClipperScalar;
+#endif
+    }
+}
+
+
+static_assert(sizeof(Clipper2Lib::Point64) == 2 * sizeof(int64_t), "Point64 is read as an array of coordinates");
+static_assert(sizeof(QPointF) == 2 * sizeof(double), "QPointF is read as an array of coordinates");
+
+void DrawingEngineUtils::toClipperCoordinates(const double* in, int64_t* out, size_t count) {
+    toClipperKernel()(in, out, count);
+}
+
+void DrawingEngineUtils::fromClipperCoordinates(const int64_t* in, double* out, size_t count) {
+    fromClipperKernel()(in, out, count);
+}
 
 // Function to convert QPainterPath to Clipper2Lib::PathsD
 Clipper2Lib::Path64 DrawingEngineUtils::convertPathToClipper(const QPainterPath& path) {
     Clipper2Lib::Path64 result;
-    for (int i = 0; i < path.elementCount(); ++i) {
+    convertPathToClipper(path, result);
+    return result;
+}
+
+void DrawingEngineUtils::convertPathToClipper(const QPainterPath& path, Clipper2Lib::Path64& result) {
+    // Elements aren't laid out as plain coordinates, so they're gathered first
+    static thread_local std::vector<double> coordinates;
+    const int count = path.elementCount();
+    coordinates.resize(static_cast<size_t>(count) * 2);
+    for (int i = 0; i < count; ++i) {
         const QPainterPath::Element& el = path.elementAt(i);
-        result.emplace_back(
-            static_cast<int64_t>(el.x * CLIPPER_SCALING),
-            static_cast<int64_t>(el.y * CLIPPER_SCALING)
-        );
+        coordinates[2 * i] = el.x;
+        coordinates[2 * i + 1] = el.y;
     }
-    return result;
+
+    result.resize(count);
+    toClipperCoordinates(coordinates.data(), reinterpret_cast<int64_t*>(result.data()), coordinates.size());
+}
+
+void DrawingEngineUtils::convertPolygonToClipper(const QPolygonF& polygon, Clipper2Lib::Path64& result) {
+    result.resize(polygon.size());
+    toClipperCoordinates(reinterpret_cast<const double*>(polygon.constData()),
+        reinterpret_cast<int64_t*>(result.data()), static_cast<size_t>(polygon.size()) * 2);
 }
+
 // Function to convert Clipper2Lib::PathsD to QPainterPath
 QPainterPath DrawingEngineUtils::convertSingleClipperPath(const Clipper2Lib::Path64& path) {
     QPainterPath result;
-    if (path.empty()) return result;
+    appendClipperPath(path, result);
+    return result;
+}
 
-    result.moveTo(
-        static_cast<qreal>(path[0].x) / CLIPPER_SCALING,
-        static_cast<qreal>(path[0].y) / CLIPPER_SCALING
-    );
+void DrawingEngineUtils::appendClipperPath(const Clipper2Lib::Path64& path, QPainterPath& result) {
+    if (path.empty()) return;
 
-    for (size_t i = 1; i < path.size(); ++i) {
-        result.lineTo(
-            static_cast<qreal>(path[i].x) / CLIPPER_SCALING,
-            static_cast<qreal>(path[i].y) / CLIPPER_SCALING
-        );
-    }
+    // The points are converted in one go, then added as a polygon. Callers
+    // appending many contours reserve room for all of them first.
+    static thread_local QPolygonF polygon;
+    polygon.resize(static_cast<qsizetype>(path.size()));
+    fromClipperCoordinates(reinterpret_cast<const int64_t*>(path.data()),
+        reinterpret_cast<double*>(polygon.data()), path.size() * 2);
 
+    result.addPolygon(polygon);
     if (path.size() > 2) {
         result.closeSubpath();
     }
+}
 
-    return result;
+void DrawingEngineUtils::appendClipperPaths(const Clipper2Lib::Paths64& paths, QPainterPath& result) {
+    // One reserve for every contour, a point per element plus the closing line
+    qsizetype elements = result.elementCount();
+    for (const Clipper2Lib::Path64& path : paths) {
+        elements += static_cast<qsizetype>(path.size()) + 1;
+    }
+    result.reserve(static_cast<int>(qMin<qsizetype>(elements, std::numeric_limits<int>::max())));
+
+    for (const Clipper2Lib::Path64& path : paths) {
+        appendClipperPath(path, result);
+    }
+}
+
+Clipper2Lib::Paths64 DrawingEngineUtils::unionSpans(const PixelSpan* spans, size_t count,
+    const QPointF& origin, const QSizeF& pixelSize, double padding) {
+    Clipper2Lib::Paths64 paths;
+    paths.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        const PixelSpan& span = spans[i];
+        const int64_t x1 = static_cast<int64_t>((origin.x() + span.x1 * pixelSize.width() - padding) * CLIPPER_SCALING);
+        const int64_t x2 = static_cast<int64_t>((origin.x() + (span.x2 + 1) * pixelSize.width() + padding) * CLIPPER_SCALING);
+        const int64_t y1 = static_cast<int64_t>((origin.y() + span.y * pixelSize.height() - padding) * CLIPPER_SCALING);
+        const int64_t y2 = static_cast<int64_t>((origin.y() + (span.y + 1) * pixelSize.height() + padding) * CLIPPER_SCALING);
+        paths.push_back({ { x1, y1 }, { x2, y1 }, { x2, y2 }, { x1, y2 } });
+    }
+
+    Clipper2Lib::Clipper64 clipper;
+    clipper.PreserveCollinear(true);
+    clipper.AddSubject(paths);
+
+    Clipper2Lib::Paths64 solution;
+    clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, solution);
+
+    solution.erase(std::remove_if(solution.begin(), solution.end(),
+        [](const Clipper2Lib::Path64& path) { return path.size() < 3; }), solution.end());
+    return solution;
 }
\ No newline at end of file
@@ -16,11 +16,59 @@ const int DEFAULT_BRUSH_SIZE = 15;
 // Other constants
 const int JPEG_QUALITY_DEFAULT = 90;
 const double CLIPPER_SCALING = 1000.0;
+const QRectF DEFAULT_SCENE_RECT(-500, -500, 1000, 1000);
+const qint64 HISTORY_MEMORY_BUDGET_DEFAULT = 64 * 1024 * 1024;
+const int IDLE_MERGE_DELAY_MS = 5000;   // Quiet time before a frame's strokes are merged automatically
+const int IDLE_MERGE_MIN_ITEMS = 256;   // Frames with fewer items aren't worth it
+const qreal DEFAULT_REFRESH_RATE = 60.0; // Pacing of coalesced input when the screen doesn't report one
+
+// Variable width strokes, as fractions of the brush size
+const qreal PRESSURE_MIN_WIDTH = 0.15;  // Width at the lightest pen pressure
+const qreal VELOCITY_MIN_WIDTH = 0.35;  // Width however fast the stroke is drawn
+const qreal VELOCITY_THINNING = 0.4;    // Thinning per scene unit per millisecond of speed
+const qreal VELOCITY_SMOOTHING = 0.3;   // How quickly the width follows the speed
 
 enum ToolType { Brush, Eraser, Fill,Select };
 
+// Run of pixels x1..x2 (inclusive) on row y
+struct PixelSpan {
+	int y, x1, x2;
+};
+
 class DrawingEngineUtils {
 public:
 	static Clipper2Lib::Path64 convertPathToClipper(const QPainterPath& path);
+	static void convertPathToClipper(const QPainterPath& path, Clipper2Lib::Path64& result); // Reuses result's capacity
 	static QPainterPath convertSingleClipperPath(const Clipper2Lib::Path64& path);
+	static void appendClipperPath(const Clipper2Lib::Path64& path, QPainterPath& result); // As a closed subpath
+	static void appendClipperPaths(const Clipper2Lib::Paths64& paths, QPainterPath& result); // Reserves for all of them once
+	static void convertPolygonToClipper(const QPolygonF& polygon, Clipper2Lib::Path64& result); // Reuses result's capacity
+
+	// Bulk conversion of count coordinates (two per point), scaling by
+	// CLIPPER_SCALING and rounding to the nearest integer on the way in. Uses
+	// AVX2 or SSE2 when the CPU has them, plain loops otherwise.
+	static void toClipperCoordinates(const double* in, int64_t* out, size_t count);
+	static void fromClipperCoordinates(const int64_t* in, double* out, size_t count);
+
+	// Appends the runs of columns left..right-1 on row for which inside(column) holds
+	template<typename Inside, typename Spans>
+	static void appendRowSpans(int row, int left, int right, Inside inside, Spans& spans) {
+		int spanStart = -1;
+		for (int column = left; column <= right; column++) {
+			const bool filled = column < right && inside(column);
+			if (filled && spanStart < 0) {
+				spanStart = column;
+			}
+			else if (!filled && spanStart >= 0) {
+				spans.push_back({ row, spanStart, column - 1 });
+				spanStart = -1;
+			}
+		}
+	}
+
+	// Unions one rectangle per span into Clipper paths scaled by CLIPPER_SCALING.
+	// Pixel (x, y) covers origin + (x, y) * pixelSize, grown by padding on every
+	// side. Degenerate contours are dropped.
+	static Clipper2Lib::Paths64 unionSpans(const PixelSpan* spans, size_t count,
+		const QPointF& origin, const QSizeF& pixelSize, double padding = 0.0);
 };
\ No newline at end of file
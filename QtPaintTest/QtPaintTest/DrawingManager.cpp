@@ -1,6 +1,10 @@
 #include "DrawingManager.h"
-#include "RemoveCommand.h"
-#include "AddCommand.h"
+#include "AddItemsCommand.h"
+#include "RemoveItemsCommand.h"
+#include "ImageTracer.h"
+#include "StrokeMerger.h"
+#include "MergeStrokesCommand.h"
+#include "PerfMonitor.h"
 
 void log(const QString& message) {
 	// Open the file and append the message
@@ -21,9 +25,14 @@ DrawingManager::DrawingManager() : m_scene(nullptr), m_width(15) {
 
 	// Set the default tool to Brush
 	m_currentTool = m_tools[0];
+
+	m_moveFlushTimer.setSingleShot(true);
+	m_moveFlushTimer.setTimerType(Qt::PreciseTimer);
+	connect(&m_moveFlushTimer, &QTimer::timeout, this, &DrawingManager::flushPendingMoves);
 }
 
 void DrawingManager::pushCommand(QUndoCommand* command) {
+    PerfScope scope("command/push"); // Pushing runs the command's redo()
     if (m_undoStack) {
         m_undoStack->push(command);
     }
@@ -39,7 +48,7 @@ void DrawingManager::setUndoStack(QUndoStack* stack) {
     if (m_undoStack) {
 		SelectTool* selectTool = dynamic_cast<SelectTool*>(m_tools[3]);
         if (selectTool) {
-            connect(m_undoStack, &QUndoStack::indexChanged, selectTool, &SelectTool::updateSelectionUI);
+            connect(m_undoStack, &QUndoStack::indexChanged, selectTool, &SelectTool::updateSelectionUI, Qt::UniqueConnection);
         }
     }
 }
@@ -51,12 +60,15 @@ void DrawingManager::copySelection() {
 
 	QList<BaseItem*> selectedItems = static_cast<SelectTool*>(m_currentTool)->getSelectedItems();
 
+    m_clipboard.reserve(selectedItems.size());
     for (BaseItem* baseItem : selectedItems) {
-		StrokeItem* item = static_cast<StrokeItem*>(baseItem);
+		StrokeItem* item = dynamic_cast<StrokeItem*>(baseItem);
+        if (!item) continue;
         if (!item->isOutlined()) {
             item->convertToFilledPath();
         }
-        m_clipboard.append({ item->path(), item->color(), item->width(), item->isOutlined() });
+        // Shares the geometry, nothing is copied until one side changes
+        m_clipboard.append(item->record());
     }
 }
 
@@ -65,12 +77,11 @@ void DrawingManager::cutSelection() {
 
     copySelection();
 
-    // We need to create a copy of the selected items since RemoveCommand will modify the scene
+    // We need to create a copy of the selected items since RemoveItemsCommand will modify the scene
 	QList<BaseItem*> itemsToRemove = static_cast<SelectTool*>(m_currentTool)->getSelectedItems();
 
-    for (BaseItem* item : itemsToRemove) {
-        RemoveCommand* cmd = new RemoveCommand(m_scene, item);
-        pushCommand(cmd);
+    if (!itemsToRemove.isEmpty()) {
+        pushCommand(new RemoveItemsCommand(m_scene, itemsToRemove));
     }
 
 	// Clear the selection
@@ -80,6 +91,7 @@ void DrawingManager::cutSelection() {
 void DrawingManager::pasteClipboard() {
     
     if (m_clipboard.isEmpty()) return;
+    StrokeFinalizer::getInstance().finishPending(); // The pasted items go on top of them
 
 	if (m_currentTool->toolName() != "Select")
 		m_currentTool = m_tools[3]; // Switch to SelectTool for pasting
@@ -89,10 +101,10 @@ void DrawingManager::pasteClipboard() {
     QRectF clipboardBounds;
     for (const auto& ci : m_clipboard) {
         if (clipboardBounds.isNull()) {
-            clipboardBounds = ci.path.boundingRect();
+            clipboardBounds = ci.sceneBoundingRect();
         }
         else {
-            clipboardBounds = clipboardBounds.united(ci.path.boundingRect());
+            clipboardBounds = clipboardBounds.united(ci.sceneBoundingRect());
         }
     }
 
@@ -101,48 +113,140 @@ void DrawingManager::pasteClipboard() {
     QPointF offsetToApply = m_lastSceneMousePos - clipboardCenter;
 
     QList<BaseItem*> pastedItems;
+    pastedItems.reserve(m_clipboard.size());
 
     for (const auto& ci : m_clipboard) {
-        StrokeItem* item = new StrokeItem(ci.color, ci.width);
-        item->setOutlined(ci.outlined);
+        // The pasted item is moved by its position, so it keeps sharing the clipboard's geometry
+        StrokeRecord record = ci;
+        record.pos += offsetToApply;
+        pastedItems.append(new StrokeItem(std::move(record)));
+    }
 
-        QPainterPath movedPath = ci.path;
-        movedPath.translate(offsetToApply);
-        item->setPath(movedPath);
+    // The whole paste is a single undo step and a single scene insertion
+    pushCommand(new AddItemsCommand(m_scene, pastedItems));
 
-        if (ci.outlined) {
-            item->setBrush(QBrush(ci.color));
-            item->setPen(QPen(ci.color.darker(120), 0.5));
-        }
-        else {
-            QPen pen(ci.color, ci.width);
-            pen.setCapStyle(Qt::RoundCap);
-            pen.setJoinStyle(Qt::RoundJoin);
-            item->setPen(pen);
-            item->setBrush(Qt::NoBrush);
-        }
+	static_cast<SelectTool*>(m_currentTool)->setSelectedItems(pastedItems);
+}
 
-        AddCommand* cmd = new AddCommand(m_scene, item);
-        pushCommand(cmd);
-        pastedItems.append(item);
-    }
+void DrawingManager::traceSelection() {
+	PerfScope scope("trace");
+	if (m_currentTool->toolName() != "Select") return;
 
-	static_cast<SelectTool*>(m_currentTool)->setSelectedItems(pastedItems);
+	QList<BaseItem*> rasters;
+	QList<BaseItem*> traced;
+	QApplication::setOverrideCursor(Qt::WaitCursor);
+	for (BaseItem* baseItem : static_cast<SelectTool*>(m_currentTool)->getSelectedItems()) {
+		RasterItem* raster = dynamic_cast<RasterItem*>(baseItem);
+		// An image still being decoded is only its placeholder or preview,
+		// tracing it would replace the real image with a blur
+		if (!raster || raster->isLoading()) continue;
+
+		rasters.append(raster);
+		for (StrokeItem* item : ImageTracer::trace(*raster)) {
+			traced.append(item);
+		}
+	}
+	QApplication::restoreOverrideCursor();
+	if (rasters.isEmpty()) return;
+
+	static_cast<SelectTool*>(m_currentTool)->clearSelection();
+
+	// The images go out and their shapes come in as a single step
+	QUndoCommand* command = new QUndoCommand(QString("Trace %1 Image(s)").arg(rasters.size()));
+	new RemoveItemsCommand(m_scene, rasters, command);
+	if (!traced.isEmpty()) {
+		new AddItemsCommand(m_scene, traced, command);
+	}
+	pushCommand(command);
+}
+
+int DrawingManager::mergeStrokes(bool wholeFrame) {
+	PerfScope scope("merge");
+	if (!m_scene) return 0;
+	StrokeFinalizer::getInstance().finishPending();
+
+	SelectTool* selectTool = dynamic_cast<SelectTool*>(m_currentTool);
+	const QList<BaseItem*> selection = selectTool ? selectTool->getSelectedItems() : QList<BaseItem*>();
+	const QSet<BaseItem*> selected(selection.begin(), selection.end());
+	QList<BaseItem*> candidates;
+	if (!wholeFrame) {
+		candidates = selection;
+	}
+	if (candidates.isEmpty()) {
+		// The whole frame, leaving out whatever the user is working on
+		for (QGraphicsItem* item : m_scene->items()) {
+			BaseItem* baseItem = dynamic_cast<BaseItem*>(item);
+			if (baseItem && !selected.contains(baseItem)) candidates.append(baseItem);
+		}
+	}
+	else if (selectTool) {
+		// Merged items are taken out of the scene, so they can't stay selected
+		selectTool->clearSelection();
+	}
+
+	StrokeMergeResult result = StrokeMerger::merge(*m_scene, candidates);
+	if (result.isEmpty()) return 0;
+
+	pushCommand(new MergeStrokesCommand(m_scene, result.originals, result.merged));
+	return result.originals.size() - result.merged.size();
 }
 
 void DrawingManager::mousePressEvent(QGraphicsSceneMouseEvent* event) {
+	flushPendingMoves();
+	PerfScope scope("tool/mousePress");
 	if (m_scene) {
 		m_currentTool->mousePressEvent(event);
 	}
 }
 void DrawingManager::mouseMoveEvent(QGraphicsSceneMouseEvent* event) {
 	m_lastSceneMousePos = event->scenePos(); // Store the last known mouse position
+	if (!m_scene) return;
 
-	if (m_scene) {
+	PerfMonitor& monitor = PerfMonitor::getInstance();
+	if (event->buttons() == Qt::NoButton) {
+		// Hovering, nothing is drawn so there is nothing to batch
+		PerfScope scope("tool/mouseMove");
 		m_currentTool->mouseMoveEvent(event);
+		return;
 	}
+
+	const qint64 now = monitor.now();
+	m_pendingMoves.append({ event->scenePos(), now, currentPressure() });
+	m_pendingMoveState = { event->widget(), event->screenPos(), event->lastScenePos(), event->buttons(), event->modifiers() };
+	event->accept();
+	if (m_moveFlushTimer.isActive()) return;
+
+	// A batch goes out at most once per refresh of the screen the view is on.
+	// The first move after a quiet spell, or after a batch that took longer
+	// than a frame, goes out as soon as the events already queued are read.
+	QScreen* screen = event->widget() ? event->widget()->screen() : QGuiApplication::primaryScreen();
+	const qreal refreshRate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : DEFAULT_REFRESH_RATE;
+	const qint64 frameInterval = qint64(1e9 / refreshRate);
+	const qint64 wait = qMax<qint64>(0, m_lastMoveFlush + frameInterval - now);
+	m_moveFlushTimer.start(int(wait / 1000000));
+}
+void DrawingManager::flushPendingMoves() {
+	m_moveFlushTimer.stop();
+	if (m_pendingMoves.isEmpty()) return;
+
+	const QList<InputSample> samples = std::move(m_pendingMoves);
+	m_pendingMoves.clear();
+	m_lastMoveFlush = PerfMonitor::getInstance().now();
+	if (!m_scene) return;
+
+	PerfScope scope("tool/mouseMove");
+	QGraphicsSceneMouseEvent event(QEvent::GraphicsSceneMouseMove);
+	event.setWidget(m_pendingMoveState.widget);
+	event.setScenePos(samples.last().scenePos);
+	event.setScreenPos(m_pendingMoveState.screenPos);
+	event.setLastScenePos(samples.size() > 1 ? samples[samples.size() - 2].scenePos : m_pendingMoveState.lastScenePos);
+	event.setButtons(m_pendingMoveState.buttons);
+	event.setModifiers(m_pendingMoveState.modifiers);
+	m_currentTool->mouseMoveBatch(samples, &event);
 }
 void DrawingManager::mouseReleaseEvent(QGraphicsSceneMouseEvent* event) {
+	flushPendingMoves(); // The tool sees every point before the stroke ends
+	PerfScope scope("tool/mouseRelease");
 	if (m_scene) {
 		m_currentTool->mouseReleaseEvent(event);
 	}
@@ -154,6 +258,7 @@ void DrawingManager::keyReleaseEvent(QKeyEvent* event) {
 	}
 }
 void DrawingManager::keyPressEvent(QKeyEvent* event) {
+    PerfScope scope("tool/keyPress");
     if (event->modifiers() & Qt::ControlModifier) {
         if (event->key() == Qt::Key_C) {
             if (m_currentTool->toolName() == "Select") {
@@ -169,6 +274,13 @@ void DrawingManager::keyPressEvent(QKeyEvent* event) {
 				return;
 			}
         }
+        if (event->key() == Qt::Key_T) {
+            if (m_currentTool->toolName() == "Select") {
+                traceSelection();
+                event->accept();
+                return;
+            }
+        }
         if (event->key() == Qt::Key_V) {
             pasteClipboard();
             event->accept();
@@ -176,11 +288,13 @@ void DrawingManager::keyPressEvent(QKeyEvent* event) {
         }
         // Add Ctrl+Z and Ctrl+Y for undo/redo
         if (event->key() == Qt::Key_Z && m_undoStack) {
+            StrokeFinalizer::getInstance().finishPending();
             m_undoStack->undo();
             event->accept();
             return;
         }
         if (event->key() == Qt::Key_Y && m_undoStack) {
+            StrokeFinalizer::getInstance().finishPending();
             m_undoStack->redo();
             event->accept();
             return;
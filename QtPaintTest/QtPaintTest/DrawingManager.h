@@ -5,6 +5,7 @@
 #include "DrawingScene.h"
 #include "ClipboardItem.h"
 #include "RasterItem.h"
+#include "StrokeFinalizer.h"
 
 #include <fstream>
 
@@ -23,6 +24,7 @@ public:
 	}
 
 	void setScene(DrawingScene* scene) {
+		flushPendingMoves(); // They belong to the old frame
 		// Reset selection state if the current tool is SelectTool
 		if (m_currentTool && m_currentTool->toolName() == "Select") {
 			SelectTool* selectTool = dynamic_cast<SelectTool*>(m_currentTool);
@@ -37,6 +39,10 @@ public:
 	}
 
 	void setCurrentTool(QString toolName) {
+		flushPendingMoves();
+		// Only the brush leaves strokes to be finished, every other tool,
+		// the eraser first of all, works on them as they'll end up
+		StrokeFinalizer::getInstance().finishPending();
 		// Reset selection state if the current tool is SelectTool
 		if (m_currentTool && m_currentTool->toolName() == "Select") {
 			SelectTool* selectTool = dynamic_cast<SelectTool*>(m_currentTool);
@@ -79,15 +85,38 @@ public:
 		return m_color;
 	}
 
+	// Brush width follows the pen's pressure and the stroke's speed
+	void setPressureSensitive(bool enabled) { m_pressureSensitive = enabled; }
+	bool isPressureSensitive() const { return m_pressureSensitive; }
+	void setVelocitySensitive(bool enabled) { m_velocitySensitive = enabled; }
+	bool isVelocitySensitive() const { return m_velocitySensitive; }
+
+	// The view passes tablet events on here and lets Qt turn them into the
+	// mouse events the tools get, which follow right after
+	void setTabletPressure(qreal pressure, bool penDown) {
+		m_tabletPressure = pressure;
+		m_tabletDown = penDown;
+	}
+	// Pressure of the current input when it counts, 1 otherwise
+	bool hasPressure() const { return m_pressureSensitive && m_tabletDown; }
+	qreal currentPressure() const { return hasPressure() ? m_tabletPressure : 1.0; }
+
 	void copySelection();
 	void cutSelection();
 	void pasteClipboard();
+	// Replaces the selected images with traced vector shapes, as one undo step
+	void traceSelection();
+	// Unions same-colored strokes of the selection, or of the whole frame when
+	// nothing is selected, as one undo step. Returns the number of items saved.
+	int mergeStrokes(bool wholeFrame = false);
 
 	void mousePressEvent(QGraphicsSceneMouseEvent* event);
 	void mouseMoveEvent(QGraphicsSceneMouseEvent* event);
 	void mouseReleaseEvent(QGraphicsSceneMouseEvent* event);
 	void keyReleaseEvent(QKeyEvent* event);
 	void keyPressEvent(QKeyEvent* event);
+	// Hands the moves queued since the last display refresh to the tool
+	void flushPendingMoves();
 
 	// Command helper function
 	void pushCommand(QUndoCommand* command);
@@ -107,10 +136,27 @@ private:
 
 	QColor m_color;
 	qreal m_width;
+	bool m_pressureSensitive = true;
+	bool m_velocitySensitive = false;
+	qreal m_tabletPressure = 1.0;
+	bool m_tabletDown = false;
 
 	QList<ClipboardItem> m_clipboard;
 	QPointF m_lastSceneMousePos; // Store last known mouse position for paste operation
 
 	QUndoStack* m_undoStack = nullptr;
+
+	// Moves made with a button held are queued and handed over as one batch
+	// per display refresh, the rest of the event is kept from the latest one
+	QList<InputSample> m_pendingMoves;
+	struct PendingMoveState {
+		QPointer<QWidget> widget;
+		QPoint screenPos;
+		QPointF lastScenePos;
+		Qt::MouseButtons buttons;
+		Qt::KeyboardModifiers modifiers;
+	} m_pendingMoveState;
+	QTimer m_moveFlushTimer;
+	qint64 m_lastMoveFlush = 0; // PerfMonitor::now() of the last batch
 };
 	
@@ -1,10 +1,57 @@
 #include "DrawingScene.h"
 #include "DrawingManager.h"
+#include "StrokeFinalizer.h"
 #include <fstream>
 
-
 DrawingScene::DrawingScene(QObject* parent)
-    : QGraphicsScene(parent) {
+    : QGraphicsScene(parent), m_undoStack(new QUndoStack(this)) {
+}
+
+DrawingScene::~DrawingScene() {
+    // The commands have to go while their items are still in the scene,
+    // QGraphicsScene deletes the items before QObject deletes the children
+    delete m_undoStack;
+}
+
+// The BSP index defers inserting new items until the next lookup, so a batch
+// costs one index update however many items it has
+void DrawingScene::addItems(const QList<BaseItem*>& items) {
+    for (BaseItem* item : items) {
+        addItem(item);
+    }
+}
+
+void DrawingScene::removeItems(const QList<BaseItem*>& items) {
+    for (BaseItem* item : items) {
+        if (item->scene() != this) continue;
+        removeItem(item);
+    }
+}
+
+DrawingScene* DrawingScene::duplicate() const {
+    // Strokes still being finished would be copied without their outline
+    StrokeFinalizer::getInstance().finishPending();
+
+    DrawingScene* copy = new DrawingScene();
+    copy->setSceneRect(sceneRect());
+    copy->setBackgroundBrush(backgroundBrush());
+
+    // Bottom to top, so items with the same z value keep their stacking order
+    QList<BaseItem*> copies;
+    for (QGraphicsItem* item : items(Qt::AscendingOrder)) {
+        // Onion skin copies are children of a group and aren't part of the frame
+        BaseItem* baseItem = dynamic_cast<BaseItem*>(item);
+        if (!baseItem || item->parentItem()) continue;
+
+        BaseItem* itemCopy = baseItem->clone();
+        itemCopy->setZValue(baseItem->zValue());
+        if (itemCopy->isSelected()) {
+            itemCopy->setSelected(false); // The selection stays with the source frame
+        }
+        copies.append(itemCopy);
+    }
+    copy->addItems(copies);
+    return copy;
 }
 
 // Handle mouse press event
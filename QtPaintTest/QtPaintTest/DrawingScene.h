@@ -14,6 +14,20 @@ class DrawingScene : public QGraphicsScene {
     Q_OBJECT
 public:
     DrawingScene(QObject* parent = nullptr);
+    ~DrawingScene();
+
+    // Every frame keeps its own history, the window switches between them with a QUndoGroup
+    QUndoStack* undoStack() const { return m_undoStack; }
+
+    // Add or remove a whole batch in one pass
+    void addItems(const QList<BaseItem*>& items);
+    void removeItems(const QList<BaseItem*>& items);
+
+    // New frame with a clone of each of this one's items, added in one batch
+    // in their stacking order. An item can only be in one scene, so this is
+    // still one new item per item.
+    DrawingScene* duplicate() const;
+
     void keyReleaseEvent(QKeyEvent* event) override;
     void keyPressEvent(QKeyEvent* event) override;
 
@@ -21,4 +35,7 @@ protected:
     void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
     void mouseMoveEvent(QGraphicsSceneMouseEvent* event) override;
     void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) override;
+
+private:
+    QUndoStack* m_undoStack;
 };
\ No newline at end of file
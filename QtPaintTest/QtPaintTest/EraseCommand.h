@@ -17,5 +17,4 @@ private:
     DrawingScene* myScene;
     QList<StrokeItem*> originalItems; // Items before erase
     QList<StrokeItem*> resultItems;   // Items after erase
-    bool firstExecution;
 };
\ No newline at end of file
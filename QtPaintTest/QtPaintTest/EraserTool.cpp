@@ -2,6 +2,8 @@
 #include "DrawingScene.h"
 #include "DrawingManager.h"
 #include "EraseCommand.h"
+#include "PerfMonitor.h"
+#include "BooleanEngine.h"
 
 EraserTool::EraserTool()
 	: m_cooldownInterval(100), m_tangentStrength(0.33) {
@@ -32,6 +34,17 @@ void EraserTool::mouseMoveEvent(QGraphicsSceneMouseEvent* event) {
 	updateEraserStroke(event->scenePos());
 	event->accept();
 }
+void EraserTool::mouseMoveBatch(const QList<InputSample>& samples, QGraphicsSceneMouseEvent* event) {
+	if (!m_currentEraserPath) return;
+
+	// Every point is kept for the curve fit, the preview is rebuilt once
+	m_points.reserve(m_points.size() + samples.size());
+	for (const InputSample& sample : samples) {
+		m_points << sample.scenePos;
+	}
+	updateTemporaryPath(m_tempEraserPathItem);
+	event->accept();
+}
 void EraserTool::mouseReleaseEvent(QGraphicsSceneMouseEvent* event) {
 	// Finalize the eraser stroke
 	finalizeEraserStroke();
@@ -66,7 +79,7 @@ void EraserTool::commitSegment(StrokeItem* pathItem, QGraphicsPathItem* tempItem
 
 	// Add cubic curve to the path
 	realPath.cubicTo(c1, c2, end);
-	pathItem->setPath(realPath);
+	pathItem->setGeometry(realPath);
 
 	// Keep only the last point for the next segment
 	m_points = { end };
@@ -166,7 +179,7 @@ void EraserTool::optimizePath(QPainterPath& path, StrokeItem* pathItem) {
 	}
 
 	path = newPath;
-	pathItem->setPath(path);
+	pathItem->setGeometry(path);
 }
 void EraserTool::updateTemporaryPath(QGraphicsPathItem* tempItem) {
 	if (!tempItem) return;
@@ -184,7 +197,8 @@ void EraserTool::updateTemporaryPath(QGraphicsPathItem* tempItem) {
 
 void EraserTool::startEraserStroke(const QPointF& pos) {
     // Create a visible eraserPath item
-    m_currentEraserPath = new StrokeItem(Qt::red, DrawingManager::getInstance().getWidth());
+    m_currentEraserPath = new StrokeItem(Qt::red, DrawingManager::getInstance().getWidth(),
+        StrokeStyleTable::forScene(DrawingManager::getInstance().getScene()));
     m_currentEraserPath->setOpacity(0.5); // Semi-transparent
     DrawingManager::getInstance().getScene()->addItem(m_currentEraserPath);
 
@@ -204,7 +218,7 @@ void EraserTool::startEraserStroke(const QPointF& pos) {
     m_points << pos;
     m_eraserRealPath = QPainterPath();
     m_eraserRealPath.moveTo(pos);
-    m_currentEraserPath->setPath(m_eraserRealPath);
+    m_currentEraserPath->setGeometry(m_eraserRealPath);
 
     // Start the cooldown timer
     m_cooldownTimer.start();
@@ -218,6 +232,7 @@ void EraserTool::updateEraserStroke(const QPointF& pos) {
 }
 // Finalize the eraser stroke
 void EraserTool::finalizeEraserStroke() {
+    PerfScope scope("eraser/finalize");
     // Stop the timer
     m_cooldownTimer.stop();
 
@@ -231,7 +246,7 @@ void EraserTool::finalizeEraserStroke() {
         // For single clicks, create a circle
         QPainterPath circlePath;
         circlePath.addEllipse(m_points.first(), DrawingManager::getInstance().getWidth() / 2, DrawingManager::getInstance().getWidth() / 2);
-        m_currentEraserPath->setPath(circlePath);
+        m_currentEraserPath->setGeometry(circlePath);
     }
 
     // Perform final path optimization
@@ -241,8 +256,8 @@ void EraserTool::finalizeEraserStroke() {
     m_currentEraserPath->convertToFilledPath();
 
     // Get the path and convert to Clipper format
-    Clipper2Lib::Path64 eraserClipperPath = DrawingEngineUtils::convertPathToClipper(m_currentEraserPath->path());
-    QPainterPath eraserQtPath = m_currentEraserPath->path();
+    Clipper2Lib::Paths64 eraserClipperPaths = m_currentEraserPath->clipperPaths();
+    QPainterPath eraserQtPath = m_currentEraserPath->geometry();
 
     // Cleanup the temporary items
     if (m_tempEraserPathItem) {
@@ -269,56 +284,13 @@ void EraserTool::finalizeEraserStroke() {
             if (stroke->parentItem()) {
                 continue;
             }
-
-            // Make sure the stroke is converted to filled path if not already
-            if (!stroke->isOutlined()) {
-                stroke->convertToFilledPath();
-            }
-
-            // Record original item
             originalItemsAffected.append(stroke);
-
-            // Get the stroke path with transform applied
-            QPainterPath strokeScenePath = stroke->path();
-
-            // Apply any transform to get scene coordinates
-            if (!stroke->transform().isIdentity() || stroke->pos() != QPointF(0, 0)) {
-                QTransform sceneTransform = stroke->sceneTransform();
-                strokeScenePath = sceneTransform.map(strokeScenePath);
-            }
-
-            // Use eraserQtPath directly
-            QPainterPath eraserPath = eraserQtPath;
-
-            // Save original color
-            QColor originalColor = stroke->color();
-
-            // APPROACH: Use Qt's subtracted function and then find separate components
-            QPainterPath resultPath = strokeScenePath.subtracted(eraserPath);
-
-            // If nothing remains, continue (item will be deleted by EraseCommand)
-            if (resultPath.isEmpty()) {
-                continue;
-            }
-
-            // Find disconnected components using floodfill-like algorithm
-            QList<QPainterPath> separatePaths = findDisconnectedComponents(resultPath);
-
-            // Create a new StrokeItem for each separate component
-            for (const QPainterPath& path : separatePaths) {
-                if (!path.isEmpty()) {
-                    StrokeItem* newStroke = new StrokeItem(originalColor, 0);
-                    newStroke->setPath(path);
-                    newStroke->setBrush(QBrush(originalColor));
-                    newStroke->setPen(QPen(originalColor.darker(120), 0.5));
-                    newStroke->setOutlined(true);
-                    resultingItems.append(newStroke);
-                    // Don't add to scene yet - EraseCommand will do that
-                }
-            }
         }
     }
 
+    PerfScope subtractScope("eraser/subtract");
+    eraseStrokes(originalItemsAffected, eraserClipperPaths, resultingItems);
+
     // Reset state
     m_points.clear();
 
@@ -329,234 +301,35 @@ void EraserTool::finalizeEraserStroke() {
         DrawingManager::getInstance().pushCommand(cmd);
     }
 }
-// Process the eraser on a single stroke
-// This function should be removed or updated to use the command pattern
-void EraserTool::processEraserOnStroke(StrokeItem* stroke, const Clipper2Lib::Path64& eraserPath) {
-    // Get the stroke path with transform applied
-    QPainterPath strokeScenePath = stroke->path();
-
-    // Apply any transform to get scene coordinates
-    if (!stroke->transform().isIdentity() || stroke->pos() != QPointF(0, 0)) {
-        QTransform sceneTransform = stroke->sceneTransform();
-        strokeScenePath = sceneTransform.map(strokeScenePath);
-    }
-
-    // Convert eraser path to Qt directly
-    QPainterPath eraserQtPath = DrawingEngineUtils::convertSingleClipperPath(eraserPath);
-
-    // Save original color and remove the original stroke
-    QColor originalColor = stroke->color();
-    DrawingManager::getInstance().getScene()->removeItem(stroke);
-    delete stroke;
-
-    // APPROACH: Use Qt's subtracted function and then find separate components
-    QPainterPath resultPath = strokeScenePath.subtracted(eraserQtPath);
-
-    // If nothing remains, we're done
-    if (resultPath.isEmpty()) {
-        return;
-    }
-
-    // Find disconnected components using floodfill-like algorithm
-    QList<QPainterPath> separatePaths = findDisconnectedComponents(resultPath);
-
-    // Create list of new items but DON'T add them directly to scene
-    QList<StrokeItem*> resultItems;
-
-    // Create a new StrokeItem for each separate component
-    for (const QPainterPath& path : separatePaths) {
-        if (!path.isEmpty()) {
-            StrokeItem* newStroke = new StrokeItem(originalColor, 0);
-            newStroke->setPath(path);
-            newStroke->setBrush(QBrush(originalColor));
-            newStroke->setPen(QPen(originalColor.darker(120), 0.5));
-            newStroke->setOutlined(true);
-            //DrawingManager::getInstance().getScene()->addItem(newStroke);
-            resultItems.append(newStroke);
+// Subtracts the eraser in Clipper coordinates, large erases spread over the
+// BooleanEngine's threads, and splits what's left into separate pieces
+void EraserTool::eraseStrokes(const QList<StrokeItem*>& strokes, const Clipper2Lib::Paths64& eraser, QList<StrokeItem*>& pieces) {
+    std::vector<BooleanEngine::Subject> subjects;
+    subjects.reserve(strokes.size());
+    for (StrokeItem* stroke : strokes) {
+        // Make sure the stroke is converted to filled path if not already
+        if (!stroke->isOutlined()) {
+            stroke->convertToFilledPath();
         }
-    }
 
-    // Create an EraseCommand to handle the change
-    QList<StrokeItem*> originalItems;
-    originalItems.append(stroke);
-    EraseCommand* cmd = new EraseCommand(DrawingManager::getInstance().getScene(), originalItems, resultItems);
-    DrawingManager::getInstance().pushCommand(cmd);
-}
-// Add this helper function to find disconnected components in a complex path
-QList<QPainterPath> EraserTool::findDisconnectedComponents(const QPainterPath& complexPath) {
-    QList<QPainterPath> components;
-
-    // Use QPainterPath elementCount and elementAt to analyze the path
-    int elementCount = complexPath.elementCount();
-    if (elementCount <= 1) {
-        if (!complexPath.isEmpty()) {
-            components.append(complexPath);
-        }
-        return components;
+        // The geometry is read here, the items belong to the scene
+        BooleanEngine::Subject subject;
+        stroke->clipperPaths(subject.paths);
+        subject.fillRule = stroke->fillRule() == Qt::WindingFill ? Clipper2Lib::FillRule::NonZero : Clipper2Lib::FillRule::EvenOdd;
+        subjects.push_back(std::move(subject));
     }
 
-    // Track subpaths by their starting positions
-    QMap<QPair<qreal, qreal>, int> subpathIndices;
-    QList<QPainterPath> subpaths;
-
-    QPainterPath currentSubpath;
-    bool subpathStarted = false;
-
-    // Extract individual subpaths
-    for (int i = 0; i < elementCount; i++) {
-        QPainterPath::Element element = complexPath.elementAt(i);
-
-        switch (element.type) {
-        case QPainterPath::MoveToElement:
-            // End previous subpath if any
-            if (subpathStarted && !currentSubpath.isEmpty()) {
-                subpaths.append(currentSubpath);
-                currentSubpath = QPainterPath();
-            }
-
-            // Start new subpath
-            currentSubpath.moveTo(element.x, element.y);
-            subpathStarted = true;
-            break;
-
-        case QPainterPath::LineToElement:
-            if (subpathStarted) {
-                currentSubpath.lineTo(element.x, element.y);
-            }
-            break;
-
-        case QPainterPath::CurveToElement:
-            if (subpathStarted && i + 2 < elementCount) {
-                QPainterPath::Element ctrl2 = complexPath.elementAt(i + 1);
-                QPainterPath::Element endPoint = complexPath.elementAt(i + 2);
-
-                if (ctrl2.type == QPainterPath::CurveToDataElement &&
-                    endPoint.type == QPainterPath::CurveToDataElement) {
-                    currentSubpath.cubicTo(
-                        element.x, element.y,
-                        ctrl2.x, ctrl2.y,
-                        endPoint.x, endPoint.y
-                    );
-                    i += 2; // Skip the control points we just processed
-                }
-            }
-            break;
-
-        case QPainterPath::CurveToDataElement:
-            // These are handled in the CurveToElement case
-            break;
-        }
-    }
-
-    // Add the last subpath if any
-    if (subpathStarted && !currentSubpath.isEmpty()) {
-        subpaths.append(currentSubpath);
-    }
-
-    // Group subpaths into connected components based on containment
-    QList<QList<int>> connectedGroups;
-    QVector<bool> processed(subpaths.size(), false);
-
-    for (int i = 0; i < subpaths.size(); i++) {
-        if (processed[i]) continue;
-
-        // Start a new group with this subpath
-        QList<int> group;
-        group.append(i);
-        processed[i] = true;
-
-        // Check all other unprocessed subpaths
-        bool addedMore;
-        do {
-            addedMore = false;
-
-            for (int j = 0; j < subpaths.size(); j++) {
-                if (processed[j]) continue;
-
-                // Check against all subpaths in the current group
-                for (int groupIdx : group) {
-                    // If one contains the other OR they intersect, they're connected
-                    QRectF rect1 = subpaths[groupIdx].boundingRect();
-                    QRectF rect2 = subpaths[j].boundingRect();
-
-                    if (rect1.intersects(rect2)) {
-                        QPointF testPoint = subpaths[j].pointAtPercent(0.0);
-                        if (subpaths[groupIdx].contains(testPoint) ||
-                            subpaths[j].contains(subpaths[groupIdx].pointAtPercent(0.0)) ||
-                            subpathsIntersect(subpaths[groupIdx], subpaths[j])) {
-
-                            group.append(j);
-                            processed[j] = true;
-                            addedMore = true;
-                            break;
-                        }
-                    }
-                }
-            }
-        } while (addedMore);
-
-        connectedGroups.append(group);
-    }
-
-    // Create a path for each connected group
-    for (const QList<int>& group : connectedGroups) {
-        QPainterPath connectedPath;
-
-        // First, handle outer subpaths (those not contained in any other)
-        for (int i : group) {
-            bool isOuter = true;
-            for (int j : group) {
-                if (i != j && subpaths[j].contains(subpaths[i].pointAtPercent(0.0))) {
-                    isOuter = false;
-                    break;
-                }
-            }
-
-            if (isOuter) {
-                if (connectedPath.isEmpty()) {
-                    connectedPath = subpaths[i];
-                }
-                else {
-                    connectedPath = connectedPath.united(subpaths[i]);
-                }
-            }
-        }
-
-        // Then handle inner subpaths (holes)
-        for (int i : group) {
-            bool isInner = false;
-            for (int j : group) {
-                if (i != j && subpaths[j].contains(subpaths[i].pointAtPercent(0.0))) {
-                    isInner = true;
-                    break;
-                }
-            }
-
-            if (isInner) {
-                // Only subtract if we have an outer path already
-                if (!connectedPath.isEmpty()) {
-                    connectedPath = connectedPath.subtracted(subpaths[i]);
-                }
-            }
-        }
-
-        if (!connectedPath.isEmpty()) {
-            // Ensure consistent fill rule
-            connectedPath.setFillRule(Qt::WindingFill);
-            components.append(connectedPath);
+    BooleanEngine::subtract(subjects, eraser);
+
+    // One new StrokeItem per separate piece, filled with a thin outline and not
+    // in the scene yet - EraseCommand will do that. If nothing remains of a
+    // stroke, EraseCommand simply deletes it.
+    for (qsizetype i = 0; i < strokes.size(); i++) {
+        const QColor color = strokes[i]->color();
+        for (const Clipper2Lib::Paths64& paths : subjects[i].pieces) {
+            StrokeItem* piece = new StrokeItem(color, strokes[i]->styleTable());
+            piece->setClipperPaths(paths);
+            pieces.append(piece);
         }
     }
-
-    return components;
-}
-// Helper to determine if two subpaths intersect
-bool EraserTool::subpathsIntersect(const QPainterPath& path1, const QPainterPath& path2) {
-    // First do a fast check with bounding rects
-    if (!path1.boundingRect().intersects(path2.boundingRect())) {
-        return false;
-    }
-
-    // A simple approach is to check if their intersection is non-empty
-    QPainterPath intersection = path1.intersected(path2);
-    return !intersection.isEmpty();
 }
\ No newline at end of file
@@ -12,6 +12,7 @@ public:
 
 	void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
 	void mouseMoveEvent(QGraphicsSceneMouseEvent* event) override;
+	void mouseMoveBatch(const QList<InputSample>& samples, QGraphicsSceneMouseEvent* event) override;
 	void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) override;
 	void keyPressEvent(QKeyEvent* event) override;
 	void keyReleaseEvent(QKeyEvent* event) override;
@@ -19,6 +20,9 @@ public:
 	QString toolName() const override { return "Eraser"; }
 	QIcon toolIcon() const override { return QIcon("icons/eraser.png"); }
 
+	// Times eraseStrokes() directly
+	friend class GeometryBenchmark;
+
 private slots:
 	void commitEraserSegment();
 
@@ -32,9 +36,9 @@ private:
 	void startEraserStroke(const QPointF& pos);
 	void updateEraserStroke(const QPointF& pos);
 	void finalizeEraserStroke();
-	void processEraserOnStroke(StrokeItem* stroke, const Clipper2Lib::Path64& eraserPath);
-	QList<QPainterPath> findDisconnectedComponents(const QPainterPath& complexPath);
-	bool subpathsIntersect(const QPainterPath& path1, const QPainterPath& path2);
+	// What's left of each stroke once eraser is cut out of it, as new items
+	// appended to pieces. Strokes that aren't outlined yet are converted first.
+	static void eraseStrokes(const QList<StrokeItem*>& strokes, const Clipper2Lib::Paths64& eraser, QList<StrokeItem*>& pieces);
 
 
 	StrokeItem* m_currentEraserPath = nullptr;
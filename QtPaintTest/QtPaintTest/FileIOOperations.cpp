@@ -1,8 +1,68 @@
 #include "FileIOOperations.h"
 #include "DrawingScene.h"
 #include "DrawingManager.h"
+#include "SvgExporter.h"
+#include "VectorImporter.h"
+#include "AddItemsCommand.h"
+#include "PerfMonitor.h"
+#include "StrokeFinalizer.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+    struct PathPoint {
+        qreal x;
+        qreal y;
+        int type;
+    };
+
+    // Rebuilds a saved path, pointAt(i) returns the i-th element
+    template <typename PointAt>
+    QPainterPath buildPath(qsizetype count, PointAt pointAt) {
+        QPainterPath path;
+        path.reserve(static_cast<int>(count));
+        bool firstPoint = true;
+
+        for (qsizetype i = 0; i < count; ++i) {
+            const PathPoint point = pointAt(i);
+
+            switch (point.type) {
+            case QPainterPath::MoveToElement:
+                path.moveTo(point.x, point.y);
+                firstPoint = false;
+                break;
+            case QPainterPath::LineToElement:
+                if (firstPoint) {
+                    path.moveTo(point.x, point.y);
+                    firstPoint = false;
+                }
+                else {
+                    path.lineTo(point.x, point.y);
+                }
+                break;
+            case QPainterPath::CurveToElement:
+                if (i + 2 < count) {
+                    const PathPoint c2 = pointAt(i + 1);
+                    const PathPoint endPoint = pointAt(i + 2);
+                    path.cubicTo(point.x, point.y, c2.x, c2.y, endPoint.x, endPoint.y);
+                    i += 2; // Skip the next two points as we've used them
+                }
+                break;
+            }
+        }
+        return path;
+    }
+
+    double readLittleEndianDouble(const char* data) {
+        const quint64 bits = qFromLittleEndian<quint64>(data);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
 
 QString FileIOOperations::currentFilePath = "";
+QvdPathEncoding FileIOOperations::saveEncoding = QvdPathEncoding::Packed;
 
 void FileIOOperations::newDrawing(QGraphicsScene& scene, MainWindow& window) {
     if (maybeSave(scene, window)) {
@@ -14,9 +74,13 @@ void FileIOOperations::newDrawing(QGraphicsScene& scene, MainWindow& window) {
                     selectTool->resetSelectionState();
                 }
             }
+
+            // The history refers to the items that are about to go
+            drawingScene->undoStack()->clear();
         }
 
         scene.clear();
+        StrokeStyleTable::resetScene(&scene); // The old drawing's styles go with it
         currentFilePath = "";
         window.setWindowTitle("Qt Vector Drawing - Untitled");
     }
@@ -40,10 +104,14 @@ void FileIOOperations::saveDrawing(QGraphicsScene& scene, MainWindow& window) {
     }
 }
 void FileIOOperations::saveDrawingAs(QGraphicsScene& scene, MainWindow& window) {
+    const QString packedFilter = "Qt Vector Drawing (*.qvd)";
+    const QString base64Filter = "Qt Vector Drawing, compact (*.qvd)";
+    QString selectedFilter = saveEncoding == QvdPathEncoding::Base64 ? base64Filter : packedFilter;
     QString fileName = QFileDialog::getSaveFileName(&window,
-        "Save Drawing", "", "Qt Vector Drawing (*.qvd)");
+        "Save Drawing", "", packedFilter + ";;" + base64Filter, &selectedFilter);
 
     if (!fileName.isEmpty()) {
+        saveEncoding = selectedFilter == base64Filter ? QvdPathEncoding::Base64 : QvdPathEncoding::Packed;
         if (!fileName.endsWith(".qvd", Qt::CaseInsensitive)) {
             fileName += ".qvd";
         }
@@ -51,6 +119,7 @@ void FileIOOperations::saveDrawingAs(QGraphicsScene& scene, MainWindow& window)
     }
 }
 bool FileIOOperations::maybeSave(QGraphicsScene& scene, MainWindow& window) {
+    StrokeFinalizer::getInstance().finishPending(); // A stroke just drawn counts as a change
     if (!DrawingManager::getInstance().hasModifications()) {
         return true;
     }
@@ -70,93 +139,65 @@ bool FileIOOperations::maybeSave(QGraphicsScene& scene, MainWindow& window) {
 }
 
 bool FileIOOperations::saveFile(const QString& fileName, const QGraphicsScene& scene, MainWindow& window) {
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly)) {
-        QMessageBox::warning(&window, "Save Error",
-            "Unable to open file for writing: " + file.errorString());
+    // The writer flushes as it goes, so a fresh one only needs a small buffer
+    QvdJsonWriter writer(saveEncoding);
+    StrokeFinalizer::getInstance().finishPending();
+    PerfScope scope("io/save");
+    if (!writer.write(fileName, scene)) {
+        QMessageBox::warning(&window, "Save Error", writer.errorString());
         return false;
     }
 
-    // Create JSON document to store drawing
-    QJsonObject root;
-    QJsonArray items;
-
-    // Store each drawing item
-    for (QGraphicsItem* item : scene.items()) {
-        if (StrokeItem* stroke = dynamic_cast<StrokeItem*>(item)) {
-            QJsonObject itemObj;
-
-            // Store type
-            itemObj["type"] = stroke->isOutlined() ? "filled" : "stroke";
-
-            // Store color
-            QColor color = stroke->color();
-            itemObj["color"] = color.name();
-            itemObj["alpha"] = color.alpha();
-
-            // Store width
-            itemObj["width"] = stroke->width();
-
-            // Store position
-            itemObj["posX"] = stroke->pos().x();
-            itemObj["posY"] = stroke->pos().y();
-
-            // Store path data
-            QJsonArray pathData;
-            QPainterPath path = stroke->path();
-            for (int i = 0; i < path.elementCount(); ++i) {
-                const QPainterPath::Element& el = path.elementAt(i);
-                QJsonObject point;
-                point["x"] = el.x;
-                point["y"] = el.y;
-                point["type"] = static_cast<int>(el.type);
-                pathData.append(point);
+    currentFilePath = fileName;
+    window.setWindowTitle("Qt Vector Drawing - " + QFileInfo(fileName).fileName());
+    window.statusBar()->showMessage("Drawing saved", 2000);
+    return true;
+}
+bool FileIOOperations::loadFile(const QString& fileName, QGraphicsScene& scene, MainWindow& window) {
+    // Reset selection state first - this prevents crashes with the selection tool
+    if (auto* drawingScene = dynamic_cast<DrawingScene*>(&scene)) {
+        if (DrawingManager::getInstance().getCurrentTool()->toolName() == "Select") {
+            SelectTool* selectTool = dynamic_cast<SelectTool*>(DrawingManager::getInstance().getCurrentTool());
+            if (selectTool) {
+                selectTool->resetSelectionState();
             }
-            itemObj["path"] = pathData;
-
-            // Add to items array
-            items.append(itemObj);
         }
     }
 
-    root["items"] = items;
-
-    // Write JSON to file
-    QJsonDocument doc(root);
-    file.write(doc.toJson());
+    QString error;
+    if (!readFile(fileName, scene, &error)) {
+        QMessageBox::warning(&window, "Load Error", error);
+        return false;
+    }
 
     currentFilePath = fileName;
     window.setWindowTitle("Qt Vector Drawing - " + QFileInfo(fileName).fileName());
-    window.statusBar()->showMessage("Drawing saved", 2000);
+    window.statusBar()->showMessage("Drawing loaded", 2000);
     return true;
 }
-bool FileIOOperations::loadFile(const QString& fileName, QGraphicsScene& scene, MainWindow& window) {
+
+bool FileIOOperations::readFile(const QString& fileName, QGraphicsScene& scene, QString* errorString) {
+    PerfScope scope("io/load");
     QFile file(fileName);
     if (!file.open(QIODevice::ReadOnly)) {
-        QMessageBox::warning(&window, "Load Error",
-            "Unable to open file: " + file.errorString());
+        if (errorString) *errorString = "Unable to open file: " + file.errorString();
         return false;
     }
 
     // Read JSON data
     QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
     if (doc.isNull()) {
-        QMessageBox::warning(&window, "Load Error", "Invalid file format");
+        if (errorString) *errorString = "Invalid file format";
         return false;
     }
 
-    // Reset selection state first - this prevents crashes with the selection tool
+    // Clear current scene, along with the history that refers to its items
     if (auto* drawingScene = dynamic_cast<DrawingScene*>(&scene)) {
-        if (DrawingManager::getInstance().getCurrentTool()->toolName() == "Select") {
-            SelectTool* selectTool = dynamic_cast<SelectTool*>(DrawingManager::getInstance().getCurrentTool());
-            if (selectTool) {
-                selectTool->resetSelectionState();
-            }
-        }
+        drawingScene->undoStack()->clear();
     }
-
-    // Clear current scene
     scene.clear();
+    StrokeStyleTable::resetScene(&scene);
+    const std::shared_ptr<StrokeStyleTable> styles = StrokeStyleTable::forScene(&scene);
 
     // Parse JSON and recreate items
     QJsonObject root = doc.object();
@@ -179,52 +220,40 @@ bool FileIOOperations::loadFile(const QString& fileName, QGraphicsScene& scene,
         StrokeItem* item;
         if (type == "filled")
             width = 0;
-        item = new StrokeItem(color, width);
+        item = new StrokeItem(color, width, styles);
 
-        // Reconstruct path
+        // Reconstruct path, from packed arrays, base64 blobs or one object per element
         QPainterPath path;
-        QJsonArray pathData = itemObj["path"].toArray();
-        bool firstPoint = true;
-
-        for (int i = 0; i < pathData.size(); ++i) {
-            QJsonObject point = pathData[i].toObject();
-            qreal x = point["x"].toDouble();
-            qreal y = point["y"].toDouble();
-            int elementType = point["type"].toInt();
-
-            switch (elementType) {
-            case QPainterPath::MoveToElement:
-                path.moveTo(x, y);
-                firstPoint = false;
-                break;
-            case QPainterPath::LineToElement:
-                if (firstPoint) {
-                    path.moveTo(x, y);
-                    firstPoint = false;
-                }
-                else {
-                    path.lineTo(x, y);
-                }
-                break;
-            case QPainterPath::CurveToElement:
-                if (i + 2 < pathData.size()) {
-                    QJsonObject c1 = pathData[i].toObject();
-                    QJsonObject c2 = pathData[i + 1].toObject();
-                    QJsonObject endPoint = pathData[i + 2].toObject();
-
-                    path.cubicTo(
-                        c1["x"].toDouble(), c1["y"].toDouble(),
-                        c2["x"].toDouble(), c2["y"].toDouble(),
-                        endPoint["x"].toDouble(), endPoint["y"].toDouble()
-                    );
-
-                    i += 2; // Skip the next two points as we've used them
-                }
-                break;
-            }
+        const QJsonValue xs = itemObj.value("xs");
+        if (xs.isArray()) {
+            const QJsonArray xArray = xs.toArray();
+            const QJsonArray yArray = itemObj.value("ys").toArray();
+            const QJsonArray typeArray = itemObj.value("types").toArray();
+            const qsizetype count = qMin(xArray.size(), qMin(yArray.size(), typeArray.size()));
+            path = buildPath(count, [&](qsizetype i) {
+                return PathPoint{ xArray.at(i).toDouble(), yArray.at(i).toDouble(), typeArray.at(i).toInt() };
+                });
+        }
+        else if (xs.isString()) {
+            const QByteArray xData = QByteArray::fromBase64(xs.toString().toLatin1());
+            const QByteArray yData = QByteArray::fromBase64(itemObj.value("ys").toString().toLatin1());
+            const QByteArray typeData = QByteArray::fromBase64(itemObj.value("types").toString().toLatin1());
+            const qsizetype count = qMin(qMin(xData.size(), yData.size()) / 8, typeData.size());
+            path = buildPath(count, [&](qsizetype i) {
+                return PathPoint{ readLittleEndianDouble(xData.constData() + i * 8),
+                    readLittleEndianDouble(yData.constData() + i * 8),
+                    static_cast<int>(typeData.at(i)) };
+                });
+        }
+        else {
+            const QJsonArray pathData = itemObj["path"].toArray();
+            path = buildPath(pathData.size(), [&](qsizetype i) {
+                const QJsonObject point = pathData.at(i).toObject();
+                return PathPoint{ point["x"].toDouble(), point["y"].toDouble(), point["type"].toInt() };
+                });
         }
 
-        item->setPath(path);
+        item->setGeometry(path);
         if (type == "filled") {
             item->setOutlined(true);
         }
@@ -237,13 +266,79 @@ bool FileIOOperations::loadFile(const QString& fileName, QGraphicsScene& scene,
         scene.addItem(item);
     }
 
-    currentFilePath = fileName;
-    window.setWindowTitle("Qt Vector Drawing - " + QFileInfo(fileName).fileName());
-    window.statusBar()->showMessage("Drawing loaded", 2000);
+    return true;
+}
+
+bool FileIOOperations::getExportResolution(const QRectF& sceneRect, MainWindow& window, QSize& size) {
+    // Create a dialog for resolution input
+    QDialog resDialog(&window);
+    resDialog.setWindowTitle("Set Export Resolution");
+    resDialog.setModal(true);
+
+    QVBoxLayout* layout = new QVBoxLayout(&resDialog);
+
+    // Add width input
+    QHBoxLayout* widthLayout = new QHBoxLayout();
+    QLabel* widthLabel = new QLabel("Width:", &resDialog);
+    QSpinBox* widthInput = new QSpinBox(&resDialog);
+    widthInput->setRange(1, 10000);
+    widthInput->setValue(sceneRect.width());
+    widthLayout->addWidget(widthLabel);
+    widthLayout->addWidget(widthInput);
+
+    // Add height input
+    QHBoxLayout* heightLayout = new QHBoxLayout();
+    QLabel* heightLabel = new QLabel("Height:", &resDialog);
+    QSpinBox* heightInput = new QSpinBox(&resDialog);
+    heightInput->setRange(1, 10000);
+    heightInput->setValue(sceneRect.height());
+    heightLayout->addWidget(heightLabel);
+    heightLayout->addWidget(heightInput);
+
+    // Add aspect ratio checkbox
+    QCheckBox* keepAspectRatio = new QCheckBox("Keep aspect ratio", &resDialog);
+    keepAspectRatio->setChecked(true);
+
+    // Connect signals to maintain aspect ratio if checked
+    double aspectRatio = static_cast<double>(sceneRect.width()) / sceneRect.height();
+    QObject::connect(widthInput, QOverload<int>::of(&QSpinBox::valueChanged), [=](int value) {
+        if (keepAspectRatio->isChecked()) {
+            heightInput->blockSignals(true);
+            heightInput->setValue(qRound(value / aspectRatio));
+            heightInput->blockSignals(false);
+        }
+        });
+
+    QObject::connect(heightInput, QOverload<int>::of(&QSpinBox::valueChanged), [=](int value) {
+        if (keepAspectRatio->isChecked()) {
+            widthInput->blockSignals(true);
+            widthInput->setValue(qRound(value * aspectRatio));
+            widthInput->blockSignals(false);
+        }
+        });
+
+    // Add buttons
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &resDialog);
+    QObject::connect(buttonBox, &QDialogButtonBox::accepted, &resDialog, &QDialog::accept);
+    QObject::connect(buttonBox, &QDialogButtonBox::rejected, &resDialog, &QDialog::reject);
+
+    // Add all widgets to dialog
+    layout->addLayout(widthLayout);
+    layout->addLayout(heightLayout);
+    layout->addWidget(keepAspectRatio);
+    layout->addWidget(buttonBox);
+
+    // Show dialog and proceed if accepted
+    if (resDialog.exec() != QDialog::Accepted) {
+        return false;
+    }
+
+    size = QSize(widthInput->value(), heightInput->value());
     return true;
 }
 
 void FileIOOperations::exportSVG(QGraphicsScene& scene, MainWindow& window) {
+    StrokeFinalizer::getInstance().finishPending(); // The last stroke is exported as it ends up
     QString fileName = QFileDialog::getSaveFileName(&window,
         "Export SVG", "", "SVG Files (*.svg)");
 
@@ -252,23 +347,18 @@ void FileIOOperations::exportSVG(QGraphicsScene& scene, MainWindow& window) {
             fileName += ".svg";
         }
 
-        QSvgGenerator generator;
-        generator.setFileName(fileName);
-        generator.setSize(QSize(scene.width(), scene.height()));
-        generator.setViewBox(QRect(0, 0, scene.width(), scene.height()));
-        generator.setTitle("Qt Vector Drawing");
-        generator.setDescription("Created with Qt Vector Drawing App");
-
-        QPainter painter;
-        painter.begin(&generator);
-        painter.setRenderHint(QPainter::Antialiasing);
-        scene.render(&painter);
-        painter.end();
-
-        window.statusBar()->showMessage("Exported to SVG", 2000);
+        SvgExporter exporter;
+        QList<FrameSnapshot> frames{ FrameExporter::snapshotScene(scene) };
+        if (exporter.write(fileName, frames, scene.sceneRect().size().toSize())) {
+            window.statusBar()->showMessage("Exported to SVG", 2000);
+        }
+        else {
+            QMessageBox::warning(&window, "Export Error", exporter.errorString());
+        }
     }
 }
 void FileIOOperations::exportPNG(QGraphicsScene& scene, MainWindow& window) {
+    StrokeFinalizer::getInstance().finishPending(); // The last stroke is exported as it ends up
     QString fileName = QFileDialog::getSaveFileName(&window,
         "Export PNG", "", "PNG Files (*.png)");
 
@@ -279,68 +369,10 @@ void FileIOOperations::exportPNG(QGraphicsScene& scene, MainWindow& window) {
 
         QRectF sceneRect = scene.sceneRect();
 
-        // Create a dialog for resolution input
-        QDialog resDialog(&window);
-        resDialog.setWindowTitle("Set Export Resolution");
-        resDialog.setModal(true);
-
-        QVBoxLayout* layout = new QVBoxLayout(&resDialog);
-
-        // Add width input
-        QHBoxLayout* widthLayout = new QHBoxLayout();
-        QLabel* widthLabel = new QLabel("Width:", &resDialog);
-        QSpinBox* widthInput = new QSpinBox(&resDialog);
-        widthInput->setRange(1, 10000);
-        widthInput->setValue(sceneRect.width());
-        widthLayout->addWidget(widthLabel);
-        widthLayout->addWidget(widthInput);
-
-        // Add height input
-        QHBoxLayout* heightLayout = new QHBoxLayout();
-        QLabel* heightLabel = new QLabel("Height:", &resDialog);
-        QSpinBox* heightInput = new QSpinBox(&resDialog);
-        heightInput->setRange(1, 10000);
-        heightInput->setValue(sceneRect.height());
-        heightLayout->addWidget(heightLabel);
-        heightLayout->addWidget(heightInput);
-
-        // Add aspect ratio checkbox
-        QCheckBox* keepAspectRatio = new QCheckBox("Keep aspect ratio", &resDialog);
-        keepAspectRatio->setChecked(true);
-
-        // Connect signals to maintain aspect ratio if checked
-        double aspectRatio = static_cast<double>(sceneRect.width()) / sceneRect.height();
-        QObject::connect(widthInput, QOverload<int>::of(&QSpinBox::valueChanged), [=](int value) {
-            if (keepAspectRatio->isChecked()) {
-                heightInput->blockSignals(true);
-                heightInput->setValue(qRound(value / aspectRatio));
-                heightInput->blockSignals(false);
-            }
-            });
-
-        QObject::connect(heightInput, QOverload<int>::of(&QSpinBox::valueChanged), [=](int value) {
-            if (keepAspectRatio->isChecked()) {
-                widthInput->blockSignals(true);
-                widthInput->setValue(qRound(value * aspectRatio));
-                widthInput->blockSignals(false);
-            }
-            });
-
-        // Add buttons
-        QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &resDialog);
-        QObject::connect(buttonBox, &QDialogButtonBox::accepted, &resDialog, &QDialog::accept);
-        QObject::connect(buttonBox, &QDialogButtonBox::rejected, &resDialog, &QDialog::reject);
-
-        // Add all widgets to dialog
-        layout->addLayout(widthLayout);
-        layout->addLayout(heightLayout);
-        layout->addWidget(keepAspectRatio);
-        layout->addWidget(buttonBox);
-
-        // Show dialog and proceed if accepted
-        if (resDialog.exec() == QDialog::Accepted) {
-            int width = widthInput->value();
-            int height = heightInput->value();
+        QSize resolution;
+        if (getExportResolution(sceneRect, window, resolution)) {
+            int width = resolution.width();
+            int height = resolution.height();
 
             QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
             image.fill(Qt::white);
@@ -361,6 +393,7 @@ void FileIOOperations::exportPNG(QGraphicsScene& scene, MainWindow& window) {
 }
 
 void FileIOOperations::exportJPEG(QGraphicsScene& scene, MainWindow& window) {
+    StrokeFinalizer::getInstance().finishPending(); // The last stroke is exported as it ends up
     QString fileName = QFileDialog::getSaveFileName(&window,
         "Export JPEG", "", "JPEG Files (*.jpg)");
 
@@ -372,68 +405,10 @@ void FileIOOperations::exportJPEG(QGraphicsScene& scene, MainWindow& window) {
 
         QRectF sceneRect = scene.sceneRect();
 
-        // Create a dialog for resolution input
-        QDialog resDialog(&window);
-        resDialog.setWindowTitle("Set Export Resolution");
-        resDialog.setModal(true);
-
-        QVBoxLayout* layout = new QVBoxLayout(&resDialog);
-
-        // Add width input
-        QHBoxLayout* widthLayout = new QHBoxLayout();
-        QLabel* widthLabel = new QLabel("Width:", &resDialog);
-        QSpinBox* widthInput = new QSpinBox(&resDialog);
-        widthInput->setRange(1, 10000);
-        widthInput->setValue(sceneRect.width());
-        widthLayout->addWidget(widthLabel);
-        widthLayout->addWidget(widthInput);
-
-        // Add height input
-        QHBoxLayout* heightLayout = new QHBoxLayout();
-        QLabel* heightLabel = new QLabel("Height:", &resDialog);
-        QSpinBox* heightInput = new QSpinBox(&resDialog);
-        heightInput->setRange(1, 10000);
-        heightInput->setValue(sceneRect.height());
-        heightLayout->addWidget(heightLabel);
-        heightLayout->addWidget(heightInput);
-
-        // Add aspect ratio checkbox
-        QCheckBox* keepAspectRatio = new QCheckBox("Keep aspect ratio", &resDialog);
-        keepAspectRatio->setChecked(true);
-
-        // Connect signals to maintain aspect ratio if checked
-        double aspectRatio = static_cast<double>(sceneRect.width()) / sceneRect.height();
-        QObject::connect(widthInput, QOverload<int>::of(&QSpinBox::valueChanged), [=](int value) {
-            if (keepAspectRatio->isChecked()) {
-                heightInput->blockSignals(true);
-                heightInput->setValue(qRound(value / aspectRatio));
-                heightInput->blockSignals(false);
-            }
-            });
-
-        QObject::connect(heightInput, QOverload<int>::of(&QSpinBox::valueChanged), [=](int value) {
-            if (keepAspectRatio->isChecked()) {
-                widthInput->blockSignals(true);
-                widthInput->setValue(qRound(value * aspectRatio));
-                widthInput->blockSignals(false);
-            }
-            });
-
-        // Add buttons
-        QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &resDialog);
-        QObject::connect(buttonBox, &QDialogButtonBox::accepted, &resDialog, &QDialog::accept);
-        QObject::connect(buttonBox, &QDialogButtonBox::rejected, &resDialog, &QDialog::reject);
-
-        // Add all widgets to dialog
-        layout->addLayout(widthLayout);
-        layout->addLayout(heightLayout);
-        layout->addWidget(keepAspectRatio);
-        layout->addWidget(buttonBox);
-
-        // Show dialog and proceed if accepted
-        if (resDialog.exec() == QDialog::Accepted) {
-            int width = widthInput->value();
-            int height = heightInput->value();
+        QSize resolution;
+        if (getExportResolution(sceneRect, window, resolution)) {
+            int width = resolution.width();
+            int height = resolution.height();
 
             // Show quality dialog
             bool ok;
@@ -458,4 +433,134 @@ void FileIOOperations::exportJPEG(QGraphicsScene& scene, MainWindow& window) {
             }
         }
     }
+}
+
+void FileIOOperations::exportAnimation(const QList<DrawingScene*>& frames, int frameRate, FrameExportFormat format, MainWindow& window) {
+    if (frames.isEmpty()) return;
+    StrokeFinalizer::getInstance().finishPending();
+
+    FrameExportOptions options;
+    options.format = format;
+    options.frameRate = frameRate;
+
+    if (format == FrameExportFormat::APNG) {
+        QString fileName = QFileDialog::getSaveFileName(&window,
+            "Export Animated PNG", "", "Animated PNG Files (*.png)");
+        if (fileName.isEmpty()) return;
+        if (!fileName.endsWith(".png", Qt::CaseInsensitive)) {
+            fileName += ".png";
+        }
+        options.outputPath = fileName;
+    }
+    else {
+        QString directory = QFileDialog::getExistingDirectory(&window, "Export Frames To");
+        if (directory.isEmpty()) return;
+        options.outputPath = directory;
+    }
+
+    if (!getExportResolution(frames.first()->sceneRect(), window, options.size)) {
+        return;
+    }
+
+    if (format == FrameExportFormat::JPEG) {
+        bool ok;
+        options.quality = QInputDialog::getInt(&window, "JPEG Quality",
+            "Select quality (0-100):", JPEG_QUALITY_DEFAULT, 0, 100, 1, &ok);
+        if (!ok) return;
+    }
+
+    // Snapshots are cheap, the geometry is shared with the scenes
+    QList<FrameSnapshot> snapshots;
+    snapshots.reserve(frames.size());
+    for (DrawingScene* frame : frames) {
+        snapshots.append(FrameExporter::snapshotScene(*frame));
+    }
+
+    QProgressDialog progressDialog("Exporting frames...", "Cancel", 0, snapshots.size(), &window);
+    progressDialog.setWindowModality(Qt::WindowModal);
+    progressDialog.setMinimumDuration(500);
+
+    FrameExporter exporter(options);
+    bool exported = exporter.exportFrames(snapshots, [&](int written, int total) {
+        progressDialog.setMaximum(total);
+        progressDialog.setValue(written);
+        QCoreApplication::processEvents(); // setValue only pumps events when the value changes
+        if (progressDialog.wasCanceled()) {
+            exporter.cancel();
+        }
+        });
+    progressDialog.reset();
+
+    if (exported) {
+        window.statusBar()->showMessage(QString("Exported %1 frames").arg(snapshots.size()), 2000);
+    }
+    else if (exporter.isCanceled()) {
+        window.statusBar()->showMessage("Export canceled", 2000);
+    }
+    else {
+        QMessageBox::warning(&window, "Export Error", exporter.errorString());
+    }
+}
+
+void FileIOOperations::exportAnimatedSVG(const QList<DrawingScene*>& frames, int frameRate, MainWindow& window) {
+    if (frames.isEmpty()) return;
+    StrokeFinalizer::getInstance().finishPending();
+
+    QString fileName = QFileDialog::getSaveFileName(&window,
+        "Export Animated SVG", "", "SVG Files (*.svg)");
+    if (fileName.isEmpty()) return;
+    if (!fileName.endsWith(".svg", Qt::CaseInsensitive)) {
+        fileName += ".svg";
+    }
+
+    QList<FrameSnapshot> snapshots;
+    snapshots.reserve(frames.size());
+    for (DrawingScene* frame : frames) {
+        snapshots.append(FrameExporter::snapshotScene(*frame));
+    }
+
+    // Every frame becomes a <g> group, shown in turn at the timeline's frame rate
+    SvgExporter exporter;
+    if (exporter.write(fileName, snapshots, frames.first()->sceneRect().size().toSize(), frameRate)) {
+        window.statusBar()->showMessage(QString("Exported %1 frames to SVG").arg(snapshots.size()), 2000);
+    }
+    else {
+        QMessageBox::warning(&window, "Export Error", exporter.errorString());
+    }
+}
+
+void FileIOOperations::importVectorFile(DrawingScene& scene, MainWindow& window) {
+    QString fileName = QFileDialog::getOpenFileName(&window,
+        "Import Vector File", "", "SVG Files (*.svg);;Clipper Test Files (*.txt)");
+    if (fileName.isEmpty()) return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QString error;
+    QList<StrokeItem*> items;
+    if (fileName.endsWith(".svg", Qt::CaseInsensitive)) {
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        items = VectorImporter::importSvg(fileName, &error);
+        QApplication::restoreOverrideCursor();
+    }
+    else {
+        bool ok;
+        int testNumber = QInputDialog::getInt(&window, "Clipper Test",
+            "Test number:", 1, 1, 100000, 1, &ok);
+        if (!ok) return;
+        items = VectorImporter::importClipperTest(fileName, testNumber, &error);
+    }
+
+    if (items.isEmpty()) {
+        QMessageBox::warning(&window, "Import Error", error);
+        return;
+    }
+
+    // All shapes go in as one undo step
+    QList<BaseItem*> baseItems(items.begin(), items.end());
+    DrawingManager::getInstance().pushCommand(new AddItemsCommand(&scene, baseItems));
+
+    window.statusBar()->showMessage(QString("Imported %1 shapes in %2 ms")
+        .arg(items.size()).arg(timer.elapsed()), 3000);
 }
\ No newline at end of file
@@ -1,11 +1,15 @@
 #pragma once
 #include <QtWidgets>
-#include <QSvgGenerator>
 #include "MainWindow.h"
+#include "FrameExporter.h"
+#include "QvdJsonWriter.h"
 
 class FileIOOperations {
 private:
 	static QString currentFilePath;
+	static QvdPathEncoding saveEncoding;
+
+	static bool getExportResolution(const QRectF& sceneRect, MainWindow& window, QSize& size);
 public:
 	// File operations
 	static void newDrawing(QGraphicsScene& scene, MainWindow& window);
@@ -17,8 +21,14 @@ public:
 	// Save and load file operations
 	static bool saveFile(const QString& fileName, const QGraphicsScene& scene, MainWindow& window);
 	static bool loadFile(const QString& fileName, QGraphicsScene& scene, MainWindow& window);
+	// Reads a drawing into the scene without touching the UI, also used by the headless renderer
+	static bool readFile(const QString& fileName, QGraphicsScene& scene, QString* errorString = nullptr);
+	// Import operations
+	static void importVectorFile(DrawingScene& scene, MainWindow& window);
 	// Export operations
 	static void exportSVG(QGraphicsScene& scene, MainWindow& window);
 	static void exportPNG(QGraphicsScene& scene, MainWindow& window);
 	static void exportJPEG(QGraphicsScene& scene, MainWindow& window);
+	static void exportAnimation(const QList<DrawingScene*>& frames, int frameRate, FrameExportFormat format, MainWindow& window);
+	static void exportAnimatedSVG(const QList<DrawingScene*>& frames, int frameRate, MainWindow& window);
 };
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "DrawingScene.h"
 #include "DrawingManager.h"
 #include "AddCommand.h"
+#include "ScratchArena.h"
+#include "PerfMonitor.h"
 
 FillTool::FillTool(){
 }
@@ -31,6 +33,7 @@ void FillTool::keyReleaseEvent(QKeyEvent* event) {
 }
 
 void FillTool::applyFill(const QPointF& pos) {
+    PerfScope scope("fill");
     // Create a temporary image of the current scene, excluding onion skin items
     QRectF sceneRect = DrawingManager::getInstance().getScene()->sceneRect();
     QImage image(sceneRect.size().toSize(), QImage::Format_ARGB32);
@@ -69,164 +72,81 @@ void FillTool::applyFill(const QPointF& pos) {
     }
 
     // Get target color
-    QRgb targetColor = image.pixel(x, y);
-
-    // Simple flood fill algorithm
-    QVector<QPoint> fillPoints;
-    QVector<bool> visited(image.width() * image.height(), false);
-    QQueue<QPoint> queue;
+    const int width = image.width();
+    const int height = image.height();
+    const int stride = image.bytesPerLine() / sizeof(QRgb);
+    const QRgb* pixels = reinterpret_cast<const QRgb*>(image.constBits());
+    QRgb targetColor = pixels[y * stride + x];
 
     // Color tolerance
     int tolerance = 30;
-
-    // Start with the seed point
-    queue.enqueue(QPoint(x, y));
-
-    // Process the queue
-    while (!queue.isEmpty()) {
-        QPoint p = queue.dequeue();
-
-        // Skip if out of bounds or already visited
-        if (p.x() < 0 || p.x() >= image.width() || p.y() < 0 || p.y() >= image.height() ||
-            visited[p.y() * image.width() + p.x()]) {
-            continue;
-        }
-
-        // Check color similarity
-        QRgb currentColor = image.pixel(p.x(), p.y());
-        bool similar =
-            qAbs(qRed(currentColor) - qRed(targetColor)) <= tolerance &&
+    auto similar = [&](int px, int py) {
+        QRgb currentColor = pixels[py * stride + px];
+        return qAbs(qRed(currentColor) - qRed(targetColor)) <= tolerance &&
             qAbs(qGreen(currentColor) - qGreen(targetColor)) <= tolerance &&
             qAbs(qBlue(currentColor) - qBlue(targetColor)) <= tolerance;
+    };
 
-        if (!similar) {
-            continue;
-        }
-
-        // Mark as visited and add to fill points
-        visited[p.y() * image.width() + p.x()] = true;
-        fillPoints.append(p);
+    // All scratch memory of the fill comes from the arena and goes away with it
+    ScratchArena arena;
 
-        // Add neighbors to queue (4-connected)
-        queue.enqueue(QPoint(p.x() + 1, p.y()));
-        queue.enqueue(QPoint(p.x() - 1, p.y()));
-        queue.enqueue(QPoint(p.x(), p.y() + 1));
-        queue.enqueue(QPoint(p.x(), p.y() - 1));
-    }
+    // Simple flood fill algorithm. Pixels are marked when queued, so every
+    // pixel is queued at most once and the queue ends up holding the fill
+    std::pmr::vector<bool> visited(static_cast<size_t>(width) * height, false, arena.resource());
+    std::pmr::vector<QPoint> fillPoints = arena.vector<QPoint>(1024);
+    int minY = y, maxY = y;
 
+    // Start with the seed point
+    visited[static_cast<size_t>(y) * width + x] = true;
+    fillPoints.push_back(QPoint(x, y));
 
-    if (fillPoints.isEmpty()) {
-        return;
-    }
-
-    // OPTIMIZATION: Convert filled pixels to horizontal spans
-    struct Span {
-        int y, x1, x2;
-        bool operator<(const Span& other) const {
-            if (y != other.y) return y < other.y;
-            return x1 < other.x1;
-        }
-    };
-
-    // Sort points by y, then x for efficient span creation
-    std::sort(fillPoints.begin(), fillPoints.end(),
-        [](const QPoint& a, const QPoint& b) {
-            if (a.y() != b.y()) return a.y() < b.y();
-            return a.x() < b.x();
-        });
-
-    // Create horizontal spans from the fill points
-    QVector<Span> spans;
-    int currentY = -1;
-    int spanStart = -1;
-
-    for (int i = 0; i < fillPoints.size(); ++i) {
-        QPoint p = fillPoints[i];
-
-        // Start new row
-        if (p.y() != currentY) {
-            currentY = p.y();
-            spanStart = p.x();
-        }
-        // Continue current span
-        else if (p.x() == fillPoints[i - 1].x() + 1) {
-            // Still in the same span, continue
-        }
-        // End previous span and start new one
-        else {
-            spans.append({ currentY, spanStart, fillPoints[i - 1].x() });
-            spanStart = p.x();
-        }
+    // Process the queue
+    for (size_t head = 0; head < fillPoints.size(); head++) {
+        const QPoint p = fillPoints[head];
+        minY = qMin(minY, p.y());
+        maxY = qMax(maxY, p.y());
 
-        // End of row or last point
-        if (i == fillPoints.size() - 1 || fillPoints[i + 1].y() != currentY) {
-            spans.append({ currentY, spanStart, p.x() });
+        // Add neighbors to queue (4-connected)
+        const QPoint neighbors[] = {
+            QPoint(p.x() + 1, p.y()), QPoint(p.x() - 1, p.y()),
+            QPoint(p.x(), p.y() + 1), QPoint(p.x(), p.y() - 1)
+        };
+        for (const QPoint& n : neighbors) {
+            // Skip if out of bounds or already visited
+            if (n.x() < 0 || n.x() >= width || n.y() < 0 || n.y() >= height) continue;
+
+            const size_t index = static_cast<size_t>(n.y()) * width + n.x();
+            if (visited[index] || !similar(n.x(), n.y())) continue;
+
+            visited[index] = true;
+            fillPoints.push_back(n);
         }
     }
 
-
-    // Convert spans to Clipper2 paths
-    Clipper2Lib::Paths64 paths;
-    const double padding = 0.1; // Small padding to ensure connectivity
+    // OPTIMIZATION: Convert filled pixels to horizontal spans. The visited
+    // map already is sorted by row, so the rows are scanned instead of sorting points
+    std::pmr::vector<PixelSpan> spans = arena.vector<PixelSpan>();
+    for (int row = minY; row <= maxY; row++) {
+        const size_t rowStart = static_cast<size_t>(row) * width;
+        DrawingEngineUtils::appendRowSpans(row, 0, width,
+            [&](int column) { return visited[rowStart + column]; }, spans);
+    }
 
     // For very large fills, limit the number of spans we process
-    const int maxSpans = 5000;
+    const size_t maxSpans = 5000;
     if (spans.size() > maxSpans) {
         spans.resize(maxSpans);
     }
 
-    for (const Span& span : spans) {
-        double sceneY1 = span.y + sceneRect.top() - padding;
-        double sceneY2 = span.y + sceneRect.top() + 1.0 + padding;
-        double sceneX1 = span.x1 + sceneRect.left() - padding;
-        double sceneX2 = span.x2 + sceneRect.left() + 1.0 + padding;
-
-        Clipper2Lib::Path64 rect;
-        rect.push_back(Clipper2Lib::Point64(static_cast<int64_t>(sceneX1 * CLIPPER_SCALING),
-            static_cast<int64_t>(sceneY1 * CLIPPER_SCALING)));
-        rect.push_back(Clipper2Lib::Point64(static_cast<int64_t>(sceneX2 * CLIPPER_SCALING),
-            static_cast<int64_t>(sceneY1 * CLIPPER_SCALING)));
-        rect.push_back(Clipper2Lib::Point64(static_cast<int64_t>(sceneX2 * CLIPPER_SCALING),
-            static_cast<int64_t>(sceneY2 * CLIPPER_SCALING)));
-        rect.push_back(Clipper2Lib::Point64(static_cast<int64_t>(sceneX1 * CLIPPER_SCALING),
-            static_cast<int64_t>(sceneY2 * CLIPPER_SCALING)));
-        paths.push_back(rect);
-    }
-
-    // Use Clipper2 to union the spans
-    Clipper2Lib::Clipper64 clipper;
-    clipper.PreserveCollinear(true);
-    clipper.AddSubject(paths);
-
-    Clipper2Lib::Paths64 solution;
-    clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, solution);
+    // Use Clipper2 to union the spans, with a small padding to ensure connectivity
+    const Clipper2Lib::Paths64 solution = DrawingEngineUtils::unionSpans(spans.data(), spans.size(),
+        sceneRect.topLeft(), QSizeF(1.0, 1.0), 0.1);
 
     if (!solution.empty()) {
-        // Convert the Clipper paths to a QPainterPath
-        QPainterPath fillPath;
-
-        for (const auto& path : solution) {
-            if (path.size() < 3) continue;
-
-            QPainterPath subPath = DrawingEngineUtils::convertSingleClipperPath(path);
-
-            if (fillPath.isEmpty()) {
-                fillPath = subPath;
-            }
-            else {
-                // Handle inner and outer contours correctly
-                if (Clipper2Lib::Area(path) < 0) {
-                    fillPath = fillPath.subtracted(subPath);
-                }
-                else {
-                    fillPath = fillPath.united(subPath);
-                }
-            }
-        }
-
         // Create a filled shape using the new constructor
-        StrokeItem* fill = new StrokeItem(DrawingManager::getInstance().getColor());
-        fill->setPath(fillPath);
+        StrokeItem* fill = new StrokeItem(DrawingManager::getInstance().getColor(),
+            StrokeStyleTable::forScene(DrawingManager::getInstance().getScene()));
+        fill->setClipperPaths(solution);
         //DrawingManager::getInstance().getScene()-> addItem(fill);
 
         AddCommand* cmd = new AddCommand(DrawingManager::getInstance().getScene(), fill);
@@ -0,0 +1,238 @@
+#include "FrameExporter.h"
+#include "StrokeItem.h"
+#include "RasterItem.h"
+#include "ApngWriter.h"
+#include <memory>
+
+FrameExporter::FrameExporter(const FrameExportOptions& options) : m_options(options) {
+}
+
+FrameSnapshot FrameExporter::snapshotScene(const QGraphicsScene& scene) {
+	FrameSnapshot snapshot;
+	snapshot.sceneRect = scene.sceneRect();
+	snapshot.background = scene.backgroundBrush();
+
+	// Bottom-most item first, the same order the scene paints in
+	for (QGraphicsItem* item : scene.items(Qt::AscendingOrder)) {
+		// Only the frame's own drawing is exported, not onion skins or selection handles
+		BaseItem* baseItem = dynamic_cast<BaseItem*>(item);
+		if (!baseItem || item->parentItem() || !item->isVisible()) continue;
+
+		FrameSnapshot::Entry entry;
+		entry.transform = item->sceneTransform();
+		entry.opacity = item->opacity();
+
+		if (RasterItem* raster = dynamic_cast<RasterItem*>(baseItem)) {
+			entry.image = raster->image();
+			entry.imageRect = raster->boundingRect();
+		}
+		else if (StrokeItem* stroke = dynamic_cast<StrokeItem*>(baseItem)) {
+			entry.path = stroke->geometry();
+			// The style without the selection highlight
+			entry.pen = stroke->style().pen;
+			entry.brush = stroke->style().brush;
+		}
+		else {
+			continue;
+		}
+		snapshot.entries.append(entry);
+	}
+
+	return snapshot;
+}
+
+QImage FrameExporter::renderSnapshot(const FrameSnapshot& snapshot, const QSize& size, bool opaque) {
+	QImage image(size, opaque ? QImage::Format_RGB32 : QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::white);
+
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::Antialiasing);
+	painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+	// Same mapping as QGraphicsScene::render with Qt::IgnoreAspectRatio
+	const QRectF& source = snapshot.sceneRect;
+	QTransform sceneToImage = QTransform::fromScale(size.width() / source.width(), size.height() / source.height());
+	sceneToImage.translate(-source.left(), -source.top());
+
+	painter.fillRect(QRectF(QPointF(0, 0), QSizeF(size)), snapshot.background);
+
+	for (const FrameSnapshot::Entry& entry : snapshot.entries) {
+		painter.setTransform(entry.transform * sceneToImage);
+		painter.setOpacity(entry.opacity);
+
+		if (!entry.image.isNull()) {
+			painter.drawImage(entry.imageRect, entry.image);
+		}
+		else {
+			// Paint from a private copy, the path's lazily built paint caches
+			// must not be shared between frames rendering at the same time
+			QPainterPath path;
+			path.setFillRule(entry.path.fillRule());
+			path.addPath(entry.path);
+
+			painter.setPen(entry.pen);
+			painter.setBrush(entry.brush);
+			painter.drawPath(path);
+		}
+	}
+	painter.end();
+
+	return image;
+}
+
+QByteArray FrameExporter::encodeImage(const QImage& image) const {
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+
+	bool ok = m_options.format == FrameExportFormat::JPEG
+		? image.save(&buffer, "JPEG", m_options.quality)
+		: image.save(&buffer, "PNG");
+
+	return ok ? data : QByteArray();
+}
+
+QString FrameExporter::frameFileName(int index) const {
+	QString extension = m_options.format == FrameExportFormat::JPEG ? "jpg" : "png";
+	if (index < m_options.frameNames.size()) {
+		return QDir(m_options.outputPath).filePath(m_options.frameNames[index] + "." + extension);
+	}
+	return QDir(m_options.outputPath).filePath(QString("%1_%2.%3")
+		.arg(m_options.baseName)
+		.arg(m_options.firstFrameNumber + index, 4, 10, QChar('0'))
+		.arg(extension));
+}
+
+bool FrameExporter::exportFrames(const QList<FrameSnapshot>& frames, const std::function<void(int, int)>& progress) {
+	m_error.clear();
+
+	const int frameCount = frames.size();
+	if (frameCount == 0) {
+		m_error = "There are no frames to export";
+		return false;
+	}
+	if (m_options.size.isEmpty()) {
+		m_error = "Invalid export resolution";
+		return false;
+	}
+
+	const bool animated = m_options.format == FrameExportFormat::APNG;
+	const bool opaque = m_options.format == FrameExportFormat::JPEG; // JPEG doesn't support transparency
+
+	QFile animationFile;
+	std::unique_ptr<ApngWriter> apng;
+	if (animated) {
+		animationFile.setFileName(m_options.outputPath);
+		if (!animationFile.open(QIODevice::WriteOnly)) {
+			m_error = "Unable to open file for writing: " + animationFile.errorString();
+			return false;
+		}
+		apng = std::make_unique<ApngWriter>(&animationFile, frameCount, m_options.frameRate);
+	}
+	else if (!QDir().mkpath(m_options.outputPath)) {
+		m_error = "Unable to create directory: " + m_options.outputPath;
+		return false;
+	}
+
+	// Pipeline: frames are rendered on one pool, compressed on another and
+	// written out in order on the calling thread
+	QThreadPool renderPool;
+	QThreadPool encodePool;
+	renderPool.setMaxThreadCount(QThread::idealThreadCount());
+	encodePool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+	const int maxInFlight = m_options.maxInFlight > 0 ? m_options.maxInFlight : 2 * renderPool.maxThreadCount();
+
+	QMutex mutex;
+	QWaitCondition frameEncoded;
+	QHash<int, QByteArray> encoded;
+	std::atomic<bool> stop{ false };
+	int dispatched = 0;
+	int written = 0;
+
+	while (written < frameCount && !m_canceled) {
+		// Keep the pipeline full without holding more than maxInFlight frames in memory
+		while (dispatched < frameCount && dispatched - written < maxInFlight) {
+			const int index = dispatched++;
+			renderPool.start([this, &frames, index, opaque, &stop, &encodePool, &mutex, &frameEncoded, &encoded]() {
+				QImage image;
+				if (!stop && !m_canceled) {
+					image = renderSnapshot(frames[index], m_options.size, opaque);
+				}
+
+				encodePool.start([this, image, index, &stop, &mutex, &frameEncoded, &encoded]() {
+					QByteArray data;
+					if (!stop && !m_canceled && !image.isNull()) {
+						data = encodeImage(image);
+					}
+
+					QMutexLocker locker(&mutex);
+					encoded.insert(index, data);
+					frameEncoded.wakeAll();
+				});
+			});
+		}
+
+		QByteArray data;
+		bool ready = false;
+		{
+			QMutexLocker locker(&mutex);
+			if (!encoded.contains(written)) {
+				frameEncoded.wait(&mutex, 50);
+			}
+			auto it = encoded.find(written);
+			if (it != encoded.end()) {
+				data = it.value();
+				encoded.erase(it);
+				ready = true;
+			}
+		}
+
+		if (!ready) {
+			// Still waiting, let the caller refresh its UI or cancel
+			if (progress) progress(written, frameCount);
+			continue;
+		}
+
+		if (data.isEmpty()) {
+			if (!m_canceled) {
+				m_error = QString("Unable to encode frame %1").arg(m_options.firstFrameNumber + written);
+			}
+			break;
+		}
+
+		bool ok = false;
+		if (animated) {
+			ok = apng->addFrame(data);
+			if (!ok) m_error = apng->errorString();
+		}
+		else {
+			QFile file(frameFileName(written));
+			ok = file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+			if (!ok) m_error = "Unable to write " + file.fileName() + ": " + file.errorString();
+		}
+		if (!ok) break;
+
+		written++;
+		if (progress) progress(written, frameCount);
+	}
+
+	// Drain the pools before the state shared with the tasks goes out of scope
+	stop = true;
+	renderPool.clear();
+	renderPool.waitForDone();
+	encodePool.clear();
+	encodePool.waitForDone();
+
+	const bool completed = written == frameCount;
+	if (animated) {
+		animationFile.close();
+		if (!completed) {
+			animationFile.remove();
+		}
+	}
+	if (!completed && m_error.isEmpty()) {
+		m_error = "Export canceled";
+	}
+
+	return completed;
+}
\ No newline at end of file
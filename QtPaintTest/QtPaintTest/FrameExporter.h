@@ -0,0 +1,62 @@
+#pragma once
+#include <QtWidgets>
+#include <atomic>
+#include <functional>
+#include "DrawingEngineUtils.h"
+
+// Copy of everything needed to paint one frame, detached from the scene so
+// it can be rendered on worker threads while the GUI keeps running
+struct FrameSnapshot {
+	struct Entry {
+		QPainterPath path;
+		QPen pen;
+		QBrush brush;
+		QImage image;      // Only set for raster items
+		QRectF imageRect;
+		QTransform transform;
+		qreal opacity = 1.0;
+	};
+
+	QRectF sceneRect;
+	QBrush background = Qt::white;
+	QList<Entry> entries;
+};
+
+enum class FrameExportFormat { PNG, JPEG, APNG };
+
+struct FrameExportOptions {
+	FrameExportFormat format = FrameExportFormat::PNG;
+	QString outputPath;           // Directory for image sequences, file name for animated output
+	QString baseName = "frame";
+	QStringList frameNames;       // Optional per-frame file names (without extension), replaces baseName numbering
+	int firstFrameNumber = 1;
+	QSize size;
+	int quality = JPEG_QUALITY_DEFAULT;
+	int frameRate = 12;
+	int maxInFlight = 0;          // Frames rendered but not yet written, 0 = twice the thread count
+};
+
+class FrameExporter {
+public:
+	explicit FrameExporter(const FrameExportOptions& options);
+
+	static FrameSnapshot snapshotScene(const QGraphicsScene& scene);
+	static QImage renderSnapshot(const FrameSnapshot& snapshot, const QSize& size, bool opaque);
+
+	// Renders and writes every frame. Progress is reported on the calling thread
+	// as (written, total), which also gives the caller a chance to cancel().
+	bool exportFrames(const QList<FrameSnapshot>& frames,
+		const std::function<void(int, int)>& progress = nullptr);
+
+	void cancel() { m_canceled = true; }
+	bool isCanceled() const { return m_canceled; }
+	QString errorString() const { return m_error; }
+
+private:
+	QByteArray encodeImage(const QImage& image) const;
+	QString frameFileName(int index) const;
+
+	FrameExportOptions m_options;
+	std::atomic<bool> m_canceled{ false };
+	QString m_error;
+};
\ No newline at end of file
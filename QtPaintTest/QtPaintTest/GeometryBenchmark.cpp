@@ -0,0 +1,329 @@
+#include "GeometryBenchmark.h"
+#include "FileIOOperations.h"
+#include "QvdJsonWriter.h"
+#include "EraserTool.h"
+#include "BooleanEngine.h"
+#include "StrokeItem.h"
+#include "DrawingEngineUtils.h"
+#include <cmath>
+#include "Utils/Timer.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+	QTextStream& errorStream() {
+		static QTextStream stream(stderr);
+		return stream;
+	}
+
+	// Nearest rank, samples are sorted
+	qint64 percentile(const QList<qint64>& samples, double p) {
+		if (samples.isEmpty()) return 0;
+		const qsizetype rank = static_cast<qsizetype>(std::ceil(p / 100.0 * samples.size()));
+		return samples[qBound<qsizetype>(0, rank - 1, samples.size() - 1)];
+	}
+
+	qint64 countPoints(const QList<QPainterPath>& paths) {
+		qint64 points = 0;
+		for (const QPainterPath& path : paths) points += path.elementCount();
+		return points;
+	}
+}
+
+bool GeometryBenchmark::isRequested(int argc, char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--benchmark") == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool GeometryBenchmark::parseArguments(const QStringList& arguments, Settings& settings, QString& error) {
+	QCommandLineParser parser;
+	QCommandLineOption benchmarkOption("benchmark", "Run the geometry benchmarks.");
+	QCommandLineOption iterationsOption("iterations", "Timed runs per case.", "n", QString::number(settings.iterations));
+	QCommandLineOption drawingsOption("drawings", "Directory with the .qvd files to load and save.", "dir");
+	QCommandLineOption filterOption("filter", "Only run cases whose name contains this.", "text");
+	QCommandLineOption labelOption("label", "Stored with the results, such as the commit being measured.", "text");
+	QCommandLineOption outOption("out", "JSON file for the results.", "file", DEFAULT_OUTPUT);
+	parser.addOptions({ benchmarkOption, iterationsOption, drawingsOption, filterOption, labelOption, outOption });
+
+	if (!parser.parse(arguments)) {
+		error = parser.errorText();
+		return false;
+	}
+
+	bool ok;
+	settings.iterations = parser.value(iterationsOption).toInt(&ok);
+	if (!ok || settings.iterations <= 0) {
+		error = "Invalid iteration count: " + parser.value(iterationsOption);
+		return false;
+	}
+
+	settings.drawingsPath = parser.isSet(drawingsOption) ? parser.value(drawingsOption) : findDrawings();
+	if (parser.isSet(drawingsOption) && !QDir(settings.drawingsPath).exists()) {
+		error = "No such directory: " + settings.drawingsPath;
+		return false;
+	}
+	settings.filter = parser.value(filterOption);
+	settings.label = parser.value(labelOption);
+	settings.outputPath = parser.value(outOption);
+	return true;
+}
+
+QString GeometryBenchmark::findDrawings() {
+	QDir dir = QDir::current();
+	for (int level = 0; level < 4; level++) {
+		if (dir.exists("TestDrawings")) return dir.filePath("TestDrawings");
+		if (!dir.cdUp()) break;
+	}
+	return QString();
+}
+
+QList<QPainterPath> GeometryBenchmark::syntheticStrokes(int count, int points, quint32 seed) {
+	QRandomGenerator random(seed);
+	QList<QPainterPath> strokes;
+	strokes.reserve(count);
+	for (int i = 0; i < count; i++) {
+		QPointF point(random.bounded(-400.0, 400.0), random.bounded(-400.0, 400.0));
+		qreal heading = random.bounded(2 * M_PI);
+
+		QPainterPath stroke(point);
+		for (int p = 1; p < points; p++) {
+			heading += random.bounded(-0.4, 0.4);
+			point += QPointF(std::cos(heading), std::sin(heading)) * random.bounded(1.0, 4.0);
+			stroke.lineTo(point);
+		}
+		strokes.append(stroke);
+	}
+	return strokes;
+}
+
+GeometryBenchmark::Result GeometryBenchmark::measure(const QString& name, int iterations, qint64 workSize,
+	const std::function<void()>& setup, const std::function<void()>& iteration) {
+	Result result;
+	result.name = name;
+	result.workSize = workSize;
+	result.samples.reserve(iterations);
+
+	// One untimed run first, so caches and lazily built tables don't count
+	if (setup) setup();
+	iteration();
+
+	Timer timer(true);
+	for (int i = 0; i < iterations; i++) {
+		if (setup) setup();
+		timer.restart();
+		iteration();
+		result.samples.append(timer.elapsed_nano());
+	}
+	std::sort(result.samples.begin(), result.samples.end());
+	return result;
+}
+
+QJsonObject GeometryBenchmark::toJson(const Result& result) {
+	qint64 total = 0;
+	for (qint64 sample : result.samples) total += sample;
+
+	QJsonObject object;
+	object["name"] = result.name;
+	object["iterations"] = static_cast<qint64>(result.samples.size());
+	object["work_size"] = result.workSize;
+	object["min_ns"] = result.samples.isEmpty() ? 0 : result.samples.first();
+	object["p50_ns"] = percentile(result.samples, 50);
+	object["p90_ns"] = percentile(result.samples, 90);
+	object["p99_ns"] = percentile(result.samples, 99);
+	object["max_ns"] = result.samples.isEmpty() ? 0 : result.samples.last();
+	object["mean_ns"] = result.samples.isEmpty() ? 0 : total / result.samples.size();
+	return object;
+}
+
+int GeometryBenchmark::run(const QStringList& arguments) {
+	Settings settings;
+	QString error;
+	if (!parseArguments(arguments, settings, error)) {
+		errorStream() << "Error: " << error << Qt::endl;
+		return InvalidArguments;
+	}
+
+	QList<Result> results;
+	auto wanted = [&](const QString& name) {
+		return settings.filter.isEmpty() || name.contains(settings.filter);
+	};
+	auto add = [&](const QString& name, qint64 workSize, const std::function<void()>& setup, const std::function<void()>& iteration) {
+		if (!wanted(name)) return;
+		errorStream() << name << Qt::endl;
+		results.append(measure(name, settings.iterations, workSize, setup, iteration));
+	};
+
+	const QList<QPainterPath> strokes = syntheticStrokes(200, 120, SEED);
+	const qreal strokeWidth = DEFAULT_BRUSH_SIZE;
+	const std::shared_ptr<StrokeStyleTable> styles = StrokeStyleTable::forScene(nullptr);
+
+	// Filled outlines of the strokes, the shape most geometry has once it's been edited
+	QList<StrokeItem*> filled;
+	for (const QPainterPath& stroke : strokes) {
+		StrokeItem* item = new StrokeItem(Qt::black, strokeWidth, styles);
+		item->setGeometry(stroke);
+		item->convertToFilledPath();
+		filled.append(item);
+	}
+	QList<QPainterPath> outlines;
+	Clipper2Lib::Paths64 clipperOutlines;
+	for (StrokeItem* item : filled) {
+		outlines.append(item->geometry());
+		Clipper2Lib::Paths64 paths = item->clipperPaths();
+		clipperOutlines.insert(clipperOutlines.end(), paths.begin(), paths.end());
+	}
+
+	// DrawingEngineUtils conversions
+	{
+		Clipper2Lib::Path64 converted;
+		add("conversion/path_to_clipper", countPoints(outlines), nullptr, [&]() {
+			for (const QPainterPath& outline : outlines) {
+				DrawingEngineUtils::convertPathToClipper(outline, converted);
+			}
+		});
+
+		qint64 clipperPoints = 0;
+		for (const Clipper2Lib::Path64& path : clipperOutlines) clipperPoints += path.size();
+		add("conversion/clipper_to_path", clipperPoints, nullptr, [&]() {
+			QPainterPath path;
+			DrawingEngineUtils::appendClipperPaths(clipperOutlines, path);
+		});
+	}
+
+	// StrokeItem::convertToFilledPath on fresh brush strokes
+	{
+		QList<StrokeItem*> items;
+		add("stroke/convert_to_filled_path", countPoints(strokes), [&]() {
+			qDeleteAll(items);
+			items.clear();
+			for (const QPainterPath& stroke : strokes) {
+				StrokeItem* item = new StrokeItem(Qt::black, strokeWidth, styles);
+				item->setGeometry(stroke);
+				items.append(item);
+			}
+		}, [&]() {
+			for (StrokeItem* item : items) {
+				item->convertToFilledPath();
+			}
+		});
+		qDeleteAll(items);
+	}
+
+	// The eraser: one wide stroke through the whole set, subtracted from every outline
+	{
+		StrokeItem eraser(Qt::black, 60, styles);
+		QPainterPath eraserPath(QPointF(-450, -450));
+		for (int i = 1; i <= 40; i++) {
+			eraserPath.lineTo(-450 + i * 22.5, -450 + i * 22.5 + (i % 2 ? 40 : -40));
+		}
+		eraser.setGeometry(eraserPath);
+		eraser.convertToFilledPath();
+		const Clipper2Lib::Paths64 eraserClipperPaths = eraser.clipperPaths();
+
+		// What finalizeEraserStroke runs, including the new items for the pieces
+		QList<StrokeItem*> pieces;
+		add("eraser/subtract", countPoints(outlines), [&]() {
+			qDeleteAll(pieces);
+			pieces.clear();
+		}, [&]() {
+			EraserTool::eraseStrokes(filled, eraserClipperPaths, pieces);
+		});
+		qDeleteAll(pieces);
+
+		// The BooleanEngine's part of it alone
+		std::vector<BooleanEngine::Subject> subjects(filled.size());
+		add("eraser/subtract_batch", countPoints(outlines), [&]() {
+			for (qsizetype i = 0; i < filled.size(); i++) {
+				filled[i]->clipperPaths(subjects[i].paths);
+			}
+		}, [&]() {
+			BooleanEngine::subtract(subjects, eraserClipperPaths);
+		});
+	}
+
+	// FillTool's span building and union, on a mask of overlapping discs
+	{
+		const int size = 1024;
+		std::vector<bool> mask(static_cast<size_t>(size) * size, false);
+		QRandomGenerator random(SEED);
+		for (int disc = 0; disc < 60; disc++) {
+			const int cx = random.bounded(size), cy = random.bounded(size), r = random.bounded(20, 120);
+			for (int y = qMax(0, cy - r); y < qMin(size, cy + r); y++) {
+				for (int x = qMax(0, cx - r); x < qMin(size, cx + r); x++) {
+					if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r) mask[static_cast<size_t>(y) * size + x] = true;
+				}
+			}
+		}
+
+		std::vector<PixelSpan> spans;
+		add("fill/spans", static_cast<qint64>(size) * size, nullptr, [&]() {
+			spans.clear();
+			for (int row = 0; row < size; row++) {
+				const size_t rowStart = static_cast<size_t>(row) * size;
+				DrawingEngineUtils::appendRowSpans(row, 0, size, [&](int column) { return mask[rowStart + column]; }, spans);
+			}
+		});
+		add("fill/union", static_cast<qint64>(spans.size()), nullptr, [&]() {
+			DrawingEngineUtils::unionSpans(spans.data(), spans.size(), QPointF(-512, -512), QSizeF(1.0, 1.0), 0.1);
+		});
+	}
+	qDeleteAll(filled);
+
+	// Loading and saving the drawings
+	QStringList drawings;
+	if (!settings.drawingsPath.isEmpty()) {
+		QDir dir(settings.drawingsPath);
+		for (const QString& name : dir.entryList({ "*.qvd" }, QDir::Files, QDir::Name)) {
+			drawings.append(dir.filePath(name));
+		}
+	}
+	QTemporaryDir temporary;
+	for (const QString& drawing : drawings) {
+		const QString baseName = QFileInfo(drawing).completeBaseName();
+		QGraphicsScene scene;
+		scene.setSceneRect(DEFAULT_SCENE_RECT);
+
+		add("io/load/" + baseName, QFileInfo(drawing).size(), [&]() { scene.clear(); }, [&]() {
+			FileIOOperations::readFile(drawing, scene);
+		});
+
+		if (scene.items().isEmpty() && !FileIOOperations::readFile(drawing, scene, &error)) {
+			errorStream() << "Skipping " << drawing << ": " << error << Qt::endl;
+			continue;
+		}
+		QvdJsonWriter writer;
+		const QString savePath = temporary.filePath(baseName + ".qvd");
+		add("io/save/" + baseName, static_cast<qint64>(scene.items().size()), nullptr, [&]() {
+			writer.write(savePath, scene);
+		});
+	}
+
+	QJsonArray cases;
+	for (const Result& result : results) {
+		cases.append(toJson(result));
+	}
+	QJsonObject root;
+	root["label"] = settings.label;
+	root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+	root["qt_version"] = QString(qVersion());
+	root["cpu"] = QSysInfo::currentCpuArchitecture();
+	root["threads"] = QThread::idealThreadCount();
+	root["seed"] = static_cast<qint64>(SEED);
+	root["iterations"] = settings.iterations;
+	root["drawings"] = settings.drawingsPath;
+	root["benchmarks"] = cases;
+	const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+	QSaveFile file(settings.outputPath);
+	if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+		errorStream() << "Error: Unable to write " << settings.outputPath << ": " << file.errorString() << Qt::endl;
+		return WriteFailed;
+	}
+	errorStream() << "Results written to " << QFileInfo(settings.outputPath).absoluteFilePath() << Qt::endl;
+	return Success;
+}
\ No newline at end of file
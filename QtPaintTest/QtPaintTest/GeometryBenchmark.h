@@ -0,0 +1,51 @@
+#pragma once
+#include <QtWidgets>
+#include <functional>
+
+// Times the geometry hot paths without showing any UI, so regressions show up per commit:
+//   QtPaintTest --benchmark [--iterations n] [--drawings dir] [--filter text] [--label text] [--out file.json]
+// The inputs are synthetic strokes from a fixed seed plus the .qvd files of the
+// drawings directory, TestDrawings next to the working directory or above it by
+// default. The results are JSON with percentiles per case, written to benchmark.json in the
+// working directory unless --out names another file. The exe is a GUI app on Windows and
+// has no console to print them to.
+class GeometryBenchmark {
+public:
+	enum ExitCode {
+		Success = 0,
+		InvalidArguments = 1,
+		WriteFailed = 3
+	};
+
+	static const quint32 SEED = 20240601;
+	static constexpr const char* DEFAULT_OUTPUT = "benchmark.json";
+
+	// Checked before the QApplication exists so the offscreen platform can be selected
+	static bool isRequested(int argc, char* argv[]);
+	static int run(const QStringList& arguments);
+
+private:
+	struct Settings {
+		int iterations = 50;
+		QString drawingsPath;
+		QString filter;
+		QString label;
+		QString outputPath;
+	};
+
+	struct Result {
+		QString name;
+		qint64 workSize = 0;    // Points, pixels or items handled per iteration
+		QList<qint64> samples;  // Nanoseconds per iteration
+	};
+
+	static bool parseArguments(const QStringList& arguments, Settings& settings, QString& error);
+	static QString findDrawings();
+	// setup runs before every iteration and isn't timed, iteration is
+	static Result measure(const QString& name, int iterations, qint64 workSize,
+		const std::function<void()>& setup, const std::function<void()>& iteration);
+	static QJsonObject toJson(const Result& result);
+
+	// Brush strokes as the BrushTool records them, a random walk of points
+	static QList<QPainterPath> syntheticStrokes(int count, int points, quint32 seed);
+};
\ No newline at end of file
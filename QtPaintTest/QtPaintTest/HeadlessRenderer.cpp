@@ -0,0 +1,193 @@
+#include "HeadlessRenderer.h"
+#include "FileIOOperations.h"
+#include <cstring>
+
+namespace {
+	QTextStream& errorStream() {
+		static QTextStream stream(stderr);
+		return stream;
+	}
+}
+
+bool HeadlessRenderer::isRequested(int argc, char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--render") == 0 || strncmp(argv[i], "--render=", 9) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool HeadlessRenderer::parseSize(const QString& text, QSize& size) {
+	const QStringList parts = text.toLower().split('x');
+	if (parts.size() != 2) return false;
+
+	bool widthOk, heightOk;
+	size = QSize(parts[0].toInt(&widthOk), parts[1].toInt(&heightOk));
+	return widthOk && heightOk && !size.isEmpty();
+}
+
+bool HeadlessRenderer::parseFrameRange(const QString& text, int frameCount, int& first, int& last) {
+	const QStringList parts = text.split('-');
+	bool firstOk = false, lastOk = false;
+	if (parts.size() == 1) {
+		first = last = parts[0].toInt(&firstOk);
+		lastOk = firstOk;
+	}
+	else if (parts.size() == 2) {
+		first = parts[0].toInt(&firstOk);
+		last = parts[1].toInt(&lastOk);
+	}
+	return firstOk && lastOk && first >= 1 && first <= last && last <= frameCount;
+}
+
+bool HeadlessRenderer::parseArguments(const QStringList& arguments, Settings& settings, QString& error) {
+	QCommandLineParser parser;
+	QCommandLineOption renderOption("render", "Drawing to render, can be given more than once.", "file");
+	QCommandLineOption outOption("out", "Output directory, or the output file for apng.", "path");
+	QCommandLineOption sizeOption("size", "Output resolution, defaults to the scene size.", "WxH");
+	QCommandLineOption framesOption("frames", "1-based range of the input files to render.", "a-b");
+	QCommandLineOption formatOption("format", "png, jpg or apng.", "format", "png");
+	QCommandLineOption qualityOption("quality", "JPEG quality (0-100).", "quality", QString::number(JPEG_QUALITY_DEFAULT));
+	QCommandLineOption fpsOption("fps", "Frame rate of animated output.", "fps", "12");
+	parser.addOptions({ renderOption, outOption, sizeOption, framesOption, formatOption, qualityOption, fpsOption });
+	parser.addPositionalArgument("files", "More drawings to render.", "[files...]");
+
+	if (!parser.parse(arguments)) {
+		error = parser.errorText();
+		return false;
+	}
+
+	settings.inputs = parser.values(renderOption) + parser.positionalArguments();
+	if (settings.inputs.isEmpty()) {
+		error = "No input files";
+		return false;
+	}
+	if (!parser.isSet(outOption)) {
+		error = "Missing --out";
+		return false;
+	}
+
+	FrameExportOptions& options = settings.options;
+	options.outputPath = parser.value(outOption);
+
+	const QString format = parser.value(formatOption).toLower();
+	if (format == "png") {
+		options.format = FrameExportFormat::PNG;
+	}
+	else if (format == "jpg" || format == "jpeg") {
+		options.format = FrameExportFormat::JPEG;
+	}
+	else if (format == "apng") {
+		options.format = FrameExportFormat::APNG;
+	}
+	else {
+		error = "Unknown format: " + format;
+		return false;
+	}
+
+	if (parser.isSet(sizeOption) && !parseSize(parser.value(sizeOption), options.size)) {
+		error = "Invalid size: " + parser.value(sizeOption);
+		return false;
+	}
+
+	bool ok;
+	options.quality = parser.value(qualityOption).toInt(&ok);
+	if (!ok || options.quality < 0 || options.quality > 100) {
+		error = "Invalid quality: " + parser.value(qualityOption);
+		return false;
+	}
+	options.frameRate = parser.value(fpsOption).toInt(&ok);
+	if (!ok || options.frameRate <= 0) {
+		error = "Invalid frame rate: " + parser.value(fpsOption);
+		return false;
+	}
+
+	if (parser.isSet(framesOption)) {
+		int first, last;
+		if (!parseFrameRange(parser.value(framesOption), settings.inputs.size(), first, last)) {
+			error = QString("Invalid frame range: %1 (there are %2 frames)")
+				.arg(parser.value(framesOption)).arg(settings.inputs.size());
+			return false;
+		}
+		settings.inputs = settings.inputs.mid(first - 1, last - first + 1);
+		options.firstFrameNumber = first;
+	}
+
+	return true;
+}
+
+bool HeadlessRenderer::loadSnapshot(const QString& fileName, FrameSnapshot& snapshot, QString& error) {
+	// Same setup as a new frame in the editor
+	QGraphicsScene scene;
+	scene.setSceneRect(DEFAULT_SCENE_RECT);
+	scene.setBackgroundBrush(Qt::white);
+
+	if (!FileIOOperations::readFile(fileName, scene, &error)) {
+		error = fileName + ": " + error;
+		return false;
+	}
+
+	// The snapshot shares the geometry, so it stays valid once the scene is gone
+	snapshot = FrameExporter::snapshotScene(scene);
+	return true;
+}
+
+int HeadlessRenderer::run(const QStringList& arguments) {
+	Settings settings;
+	QString error;
+	if (!parseArguments(arguments, settings, error)) {
+		errorStream() << "Error: " << error << Qt::endl;
+		return InvalidArguments;
+	}
+
+	FrameExportOptions& options = settings.options;
+	const QStringList& inputs = settings.inputs;
+
+	// Name sequence frames after their drawings unless that would make two files collide
+	if (options.format != FrameExportFormat::APNG) {
+		QStringList names;
+		for (const QString& input : inputs) {
+			names.append(QFileInfo(input).completeBaseName());
+		}
+		if (QSet<QString>(names.begin(), names.end()).size() == names.size()) {
+			options.frameNames = names;
+		}
+	}
+
+	// Animations need every frame in one go, sequences are loaded in chunks
+	// so only a bounded number of documents are held in memory at once
+	const int chunkSize = options.format == FrameExportFormat::APNG
+		? inputs.size()
+		: 4 * QThread::idealThreadCount();
+
+	for (int chunkStart = 0; chunkStart < inputs.size(); chunkStart += chunkSize) {
+		const int count = qMin(chunkSize, inputs.size() - chunkStart);
+
+		QList<FrameSnapshot> snapshots;
+		snapshots.reserve(count);
+		for (int i = chunkStart; i < chunkStart + count; i++) {
+			FrameSnapshot snapshot;
+			if (!loadSnapshot(inputs[i], snapshot, error)) {
+				errorStream() << "Error: " << error << Qt::endl;
+				return LoadFailed;
+			}
+			snapshots.append(snapshot);
+		}
+
+		FrameExportOptions chunkOptions = options;
+		if (chunkOptions.size.isEmpty()) {
+			chunkOptions.size = snapshots.first().sceneRect.size().toSize();
+		}
+		chunkOptions.firstFrameNumber = options.firstFrameNumber + chunkStart;
+		chunkOptions.frameNames = options.frameNames.mid(chunkStart, count);
+
+		FrameExporter exporter(chunkOptions);
+		if (!exporter.exportFrames(snapshots)) {
+			errorStream() << "Error: " << exporter.errorString() << Qt::endl;
+			return ExportFailed;
+		}
+	}
+
+	return Success;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+#include <QtWidgets>
+#include "FrameExporter.h"
+
+// Command line conversion of .qvd drawings without showing any UI:
+//   QtPaintTest --render in.qvd [more.qvd ...] --out dir [--size WxH] [--frames a-b]
+//               [--format png|jpg|apng] [--quality q] [--fps n]
+// Every input file is one frame, --frames picks a 1-based inclusive range of them.
+class HeadlessRenderer {
+public:
+	enum ExitCode {
+		Success = 0,
+		InvalidArguments = 1,
+		LoadFailed = 2,
+		ExportFailed = 3
+	};
+
+	// Checked before the QApplication exists so the offscreen platform can be selected
+	static bool isRequested(int argc, char* argv[]);
+	static int run(const QStringList& arguments);
+
+private:
+	struct Settings {
+		QStringList inputs;
+		FrameExportOptions options;
+	};
+
+	static bool parseArguments(const QStringList& arguments, Settings& settings, QString& error);
+	static bool parseSize(const QString& text, QSize& size);
+	static bool parseFrameRange(const QString& text, int frameCount, int& first, int& last);
+	static bool loadSnapshot(const QString& fileName, FrameSnapshot& snapshot, QString& error);
+};
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "HistoryStore.h"
+#include <algorithm>
+
+namespace {
+	const int COMPRESSION_LEVEL = 1; // Fast, paths still shrink well
+	const qint64 COMPACT_THRESHOLD = 16 * 1024 * 1024;
+
+	template<typename T>
+	QByteArray serialize(const T& value) {
+		QByteArray bytes;
+		QDataStream stream(&bytes, QIODevice::WriteOnly);
+		stream << value;
+		return bytes;
+	}
+}
+
+HistoryStore::HistoryStore() {
+}
+
+HistoryStore::Key HistoryStore::store(const QByteArray& bytes) {
+	QMutexLocker locker(&m_mutex);
+	Key key = static_cast<Key>(qHashBits(bytes.constData(), bytes.size(), 0x9e3779b9)) ^ (static_cast<Key>(bytes.size()) << 32);
+
+	while (true) {
+		auto it = m_entries.find(key);
+		if (it == m_entries.end()) {
+			Entry entry;
+			entry.data = qCompress(bytes, COMPRESSION_LEVEL);
+			entry.size = entry.data.size();
+			entry.refCount = 1;
+			entry.lastUse = ++m_useCounter;
+			m_memoryUsage += entry.size;
+			m_entries.insert(key, entry);
+
+			trimToBudget();
+			return key;
+		}
+
+		// Same geometry, share the entry
+		if (qUncompress(readData(it.value())) == bytes) {
+			it->refCount++;
+			it->lastUse = ++m_useCounter;
+			return key;
+		}
+
+		key++; // Hash collision, try the next key
+	}
+}
+
+QByteArray HistoryStore::load(Key key) {
+	QMutexLocker locker(&m_mutex);
+	auto it = m_entries.find(key);
+	if (it == m_entries.end()) return QByteArray();
+
+	it->lastUse = ++m_useCounter;
+	return qUncompress(readData(it.value()));
+}
+
+void HistoryStore::retain(Key key) {
+	QMutexLocker locker(&m_mutex);
+	auto it = m_entries.find(key);
+	if (it != m_entries.end()) {
+		it->refCount++;
+	}
+}
+
+void HistoryStore::release(Key key) {
+	QMutexLocker locker(&m_mutex);
+	auto it = m_entries.find(key);
+	if (it == m_entries.end() || --it->refCount > 0) return;
+
+	if (it->fileOffset < 0) {
+		m_memoryUsage -= it->size;
+	}
+	else {
+		m_diskUsage -= it->size;
+		m_diskGarbage += it->size;
+	}
+	m_entries.erase(it);
+
+	if (m_diskGarbage > COMPACT_THRESHOLD && m_diskGarbage > m_diskUsage) {
+		compactSpillFile();
+	}
+}
+
+void HistoryStore::setMemoryBudget(qint64 bytes) {
+	QMutexLocker locker(&m_mutex);
+	m_memoryBudget = qMax<qint64>(0, bytes);
+	trimToBudget();
+}
+
+qint64 HistoryStore::memoryUsage() const {
+	QMutexLocker locker(&m_mutex);
+	return m_memoryUsage;
+}
+
+qint64 HistoryStore::diskUsage() const {
+	QMutexLocker locker(&m_mutex);
+	return m_diskUsage + m_diskGarbage;
+}
+
+int HistoryStore::entryCount() const {
+	QMutexLocker locker(&m_mutex);
+	return m_entries.size();
+}
+
+QByteArray HistoryStore::readData(const Entry& entry) {
+	if (entry.fileOffset < 0) return entry.data;
+
+	if (!m_spillFile || !m_spillFile->seek(entry.fileOffset)) return QByteArray();
+	return m_spillFile->read(entry.size);
+}
+
+void HistoryStore::trimToBudget() {
+	if (m_memoryUsage <= m_memoryBudget) return;
+
+	if (!m_spillFile) {
+		m_spillFile = std::make_unique<QTemporaryFile>();
+		if (!m_spillFile->open()) {
+			m_spillFile.reset();
+			return; // Nowhere to spill to, everything stays in memory
+		}
+	}
+
+	// Least recently used first, down to three quarters of the budget so
+	// the next few stores don't immediately spill again
+	QList<QHash<Key, Entry>::iterator> inMemory;
+	for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+		if (it->fileOffset < 0) inMemory.append(it);
+	}
+	std::sort(inMemory.begin(), inMemory.end(), [](const auto& a, const auto& b) {
+		return a->lastUse < b->lastUse;
+	});
+
+	const qint64 target = m_memoryBudget / 4 * 3;
+	for (auto& it : inMemory) {
+		if (m_memoryUsage <= target) break;
+
+		const qint64 offset = m_spillFile->size();
+		if (!m_spillFile->seek(offset) || m_spillFile->write(it->data) != it->data.size()) {
+			break;
+		}
+		it->fileOffset = offset;
+		it->data = QByteArray();
+		m_memoryUsage -= it->size;
+		m_diskUsage += it->size;
+	}
+}
+
+void HistoryStore::compactSpillFile() {
+	if (!m_spillFile) return;
+
+	if (m_diskUsage == 0) {
+		m_spillFile->resize(0);
+		m_diskGarbage = 0;
+		return;
+	}
+
+	// Copy the live entries to a fresh file, the old one is only dropped once that worked
+	auto compacted = std::make_unique<QTemporaryFile>();
+	if (!compacted->open()) return;
+
+	QList<QPair<Entry*, qint64>> moved;
+	for (Entry& entry : m_entries) {
+		if (entry.fileOffset < 0) continue;
+
+		const QByteArray data = readData(entry);
+		const qint64 offset = compacted->pos();
+		if (data.size() != entry.size || compacted->write(data) != data.size()) return;
+		moved.append({ &entry, offset });
+	}
+
+	for (const auto& move : moved) {
+		move.first->fileOffset = move.second;
+	}
+	m_spillFile = std::move(compacted);
+	m_diskGarbage = 0;
+}
+
+StoredPath::StoredPath(const QPainterPath& path)
+	: m_key(HistoryStore::getInstance().store(serialize(path))), m_valid(true) {
+}
+
+StoredPath::StoredPath(const CompactPath& path)
+	: m_key(HistoryStore::getInstance().store(serialize(path))), m_valid(true), m_compact(true) {
+}
+
+StoredPath::StoredPath(const StoredPath& other) : m_key(other.m_key), m_valid(other.m_valid), m_compact(other.m_compact) {
+	if (m_valid) {
+		HistoryStore::getInstance().retain(m_key);
+	}
+}
+
+StoredPath::StoredPath(StoredPath&& other) noexcept : m_key(other.m_key), m_valid(other.m_valid), m_compact(other.m_compact) {
+	other.m_valid = false;
+}
+
+StoredPath& StoredPath::operator=(StoredPath&& other) noexcept {
+	if (this != &other) {
+		reset();
+		m_key = other.m_key;
+		m_valid = other.m_valid;
+		m_compact = other.m_compact;
+		other.m_valid = false;
+	}
+	return *this;
+}
+
+StoredPath& StoredPath::operator=(const StoredPath& other) {
+	if (other.m_valid) {
+		HistoryStore::getInstance().retain(other.m_key);
+	}
+	reset();
+	m_key = other.m_key;
+	m_valid = other.m_valid;
+	m_compact = other.m_compact;
+	return *this;
+}
+
+StoredPath::~StoredPath() {
+	reset();
+}
+
+QPainterPath StoredPath::path() const {
+	if (!m_valid) return QPainterPath();
+	if (m_compact) return compactPath().toPath();
+
+	QPainterPath path;
+	QDataStream stream(HistoryStore::getInstance().load(m_key));
+	stream >> path;
+	return path;
+}
+
+CompactPath StoredPath::compactPath() const {
+	CompactPath path;
+	if (m_valid && m_compact) {
+		QDataStream stream(HistoryStore::getInstance().load(m_key));
+		stream >> path;
+	}
+	return path;
+}
+
+void StoredPath::reset() {
+	if (m_valid) {
+		HistoryStore::getInstance().release(m_key);
+		m_valid = false;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include <QtWidgets>
+#include <memory>
+#include "DrawingEngineUtils.h"
+#include "CompactPath.h"
+
+// Compressed, content-addressed storage for the geometry of items that only
+// the undo history refers to. Identical paths are stored once. When the
+// entries held in memory exceed the budget, the least recently used ones are
+// moved to a temporary file.
+class HistoryStore {
+private:
+	HistoryStore();
+	HistoryStore(const HistoryStore&) = delete;
+	HistoryStore& operator=(const HistoryStore&) = delete;
+public:
+	using Key = quint64;
+
+	static HistoryStore& getInstance() {
+		static HistoryStore instance;
+		return instance;
+	}
+
+	// store() and retain() add a reference, release() drops one. The bytes are
+	// whatever the caller serialized, StoredPath keeps track of what they hold.
+	Key store(const QByteArray& bytes);
+	QByteArray load(Key key);
+	void retain(Key key);
+	void release(Key key);
+
+	void setMemoryBudget(qint64 bytes);
+	qint64 memoryBudget() const { return m_memoryBudget; }
+	qint64 memoryUsage() const;
+	qint64 diskUsage() const;
+	int entryCount() const;
+
+private:
+	struct Entry {
+		QByteArray data;        // Compressed bytes, empty while spilled
+		qint64 fileOffset = -1; // Position in the spill file, -1 while in memory
+		qsizetype size = 0;     // Compressed size
+		int refCount = 0;
+		quint64 lastUse = 0;
+	};
+
+	QByteArray readData(const Entry& entry);
+	void trimToBudget();
+	void compactSpillFile();
+
+	mutable QMutex m_mutex;
+	QHash<Key, Entry> m_entries;
+	std::unique_ptr<QTemporaryFile> m_spillFile; // Created on the first spill
+	qint64 m_memoryBudget = HISTORY_MEMORY_BUDGET_DEFAULT;
+	qint64 m_memoryUsage = 0;
+	qint64 m_diskUsage = 0;   // Live bytes in the spill file
+	qint64 m_diskGarbage = 0; // Bytes of released entries still in the spill file
+	quint64 m_useCounter = 0;
+};
+
+// Reference to a path in the HistoryStore, released with the last copy.
+// Compact paths are stored in their quantized form, not as a QPainterPath.
+class StoredPath {
+public:
+	StoredPath() = default;
+	explicit StoredPath(const QPainterPath& path);
+	explicit StoredPath(const CompactPath& path);
+	StoredPath(const StoredPath& other);
+	StoredPath(StoredPath&& other) noexcept;
+	StoredPath& operator=(const StoredPath& other);
+	StoredPath& operator=(StoredPath&& other) noexcept;
+	~StoredPath();
+
+	bool isNull() const { return !m_valid; }
+	bool isCompact() const { return m_compact; }
+	QPainterPath path() const; // Also decodes compact paths
+	CompactPath compactPath() const; // Null unless isCompact()
+	void reset();
+
+private:
+	HistoryStore::Key m_key = 0;
+	bool m_valid = false;
+	bool m_compact = false;
+};
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "ImageImporter.h"
+#include <memory>
+
+namespace {
+	// Runs on the GUI thread. The store is gone if every item using it was deleted meanwhile
+	// The full image ends the loading, a preview doesn't
+	void deliver(const std::weak_ptr<RasterTileStore>& tiles, const QPointer<QGraphicsScene>& scene, const QImage& image,
+		bool complete) {
+		if (!qApp || image.isNull()) return;
+
+		QMetaObject::invokeMethod(qApp, [tiles, scene, image, complete]() {
+			std::shared_ptr<RasterTileStore> store = tiles.lock();
+			if (!store) return;
+
+			store->replaceImage(image);
+			if (complete) store->setLoading(false);
+			if (scene) scene->update();
+		}, Qt::QueuedConnection);
+	}
+
+	// Runs on the GUI thread. The placeholders are the scene's items drawing
+	// from the store, copies included
+	void fail(const std::weak_ptr<RasterTileStore>& tiles, const QPointer<QGraphicsScene>& scene,
+		const QString& error, const ImageImporter::FailureHandler& onFailed) {
+		if (!qApp) return;
+
+		QMetaObject::invokeMethod(qApp, [tiles, scene, error, onFailed]() {
+			QList<RasterItem*> placeholders;
+			std::shared_ptr<RasterTileStore> store = tiles.lock();
+			if (store) store->setLoading(false);
+			if (!onFailed) return;
+			if (store && scene) {
+				for (QGraphicsItem* item : scene->items()) {
+					RasterItem* raster = dynamic_cast<RasterItem*>(item);
+					if (raster && raster->tiles() == store) placeholders.append(raster);
+				}
+			}
+			onFailed(placeholders, error);
+		}, Qt::QueuedConnection);
+	}
+}
+
+QList<RasterItem*> ImageImporter::importImages(const QStringList& fileNames, QGraphicsScene* scene,
+	QString* errorString, const FailureHandler& onFailed) {
+	QList<RasterItem*> items;
+	QStringList errors;
+
+	for (const QString& fileName : fileNames) {
+		QImageReader reader(fileName);
+		const QSize size = reader.size();
+		if (!reader.canRead() || !size.isValid()) {
+			errors.append(QFileInfo(fileName).fileName() + ": " + reader.errorString());
+			continue;
+		}
+
+		// A flat gray pixel stretched over the image's size until the first pixels arrive
+		QImage placeholder(1, 1, QImage::Format_RGB32);
+		placeholder.fill(Qt::lightGray);
+		RasterItem* item = new RasterItem(placeholder, size);
+		item->tiles()->setLoading(true);
+		items.append(item);
+
+		const bool scaledDecoding = reader.supportsOption(QImageIOHandler::ScaledSize)
+			&& qMax(size.width(), size.height()) > PREVIEW_SIZE;
+
+		std::weak_ptr<RasterTileStore> tiles = item->tiles();
+		QPointer<QGraphicsScene> target = scene;
+		QThreadPool::globalInstance()->start([fileName, size, scaledDecoding, tiles, target, onFailed]() {
+			if (scaledDecoding) {
+				QImageReader previewReader(fileName);
+				previewReader.setScaledSize(size.scaled(PREVIEW_SIZE, PREVIEW_SIZE, Qt::KeepAspectRatio));
+				deliver(tiles, target, previewReader.read(), false);
+			}
+
+			// No point decoding the full image for an item that's already gone
+			if (tiles.expired()) return;
+
+			QImageReader fullReader(fileName);
+			const QImage image = fullReader.read();
+			if (image.isNull()) {
+				// Reported the same way as a file whose header can't be read
+				fail(tiles, target, QFileInfo(fileName).fileName() + ": " + fullReader.errorString(), onFailed);
+				return;
+			}
+			deliver(tiles, target, image, true);
+		});
+	}
+
+	if (errorString) *errorString = errors.join('\n');
+	return items;
+}
\ No newline at end of file
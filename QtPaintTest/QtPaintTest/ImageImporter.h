@@ -0,0 +1,26 @@
+#pragma once
+#include <QtWidgets>
+#include "RasterItem.h"
+#include <functional>
+
+// Imports image files without blocking the GUI. Every file gets a placeholder
+// item of the right size straight away, decoding happens on the global thread
+// pool, one file per task, and the decoded pixels are swapped into the item's
+// RasterTileStore back on the GUI thread.
+class ImageImporter {
+public:
+	// Longest side of the quick preview decoded first for formats that can
+	// decode scaled down, such as JPEG
+	static const int PREVIEW_SIZE = 512;
+
+	// Called on the GUI thread when a file whose header was fine fails to
+	// decode, with the placeholders for it still in the scene
+	using FailureHandler = std::function<void(const QList<RasterItem*>& placeholders, const QString& error)>;
+
+	// Only reads the file headers, the items can be added to scene right away.
+	// scene is repainted whenever an image arrives. Files that can't be read
+	// are skipped and reported in errorString, files that turn out to be
+	// broken later go to onFailed.
+	static QList<RasterItem*> importImages(const QStringList& fileNames, QGraphicsScene* scene,
+		QString* errorString = nullptr, const FailureHandler& onFailed = nullptr);
+};
\ No newline at end of file
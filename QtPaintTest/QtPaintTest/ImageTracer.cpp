@@ -0,0 +1,192 @@
+#include "ImageTracer.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+	const quint8 NO_COLOR = 255;
+	const int ROW_BAND = 64;            // Rows per task when scanning the whole image
+	const int MIN_COLOR_DISTANCE = 48;  // Palette colors closer than this are merged
+
+	// 4 bits per channel, enough to tell the colors of a scan apart
+	int histogramBin(QRgb color) {
+		return ((qRed(color) >> 4) << 8) | ((qGreen(color) >> 4) << 4) | (qBlue(color) >> 4);
+	}
+
+	int colorDistance(QRgb a, QRgb b) {
+		return qAbs(qRed(a) - qRed(b)) + qAbs(qGreen(a) - qGreen(b)) + qAbs(qBlue(a) - qBlue(b));
+	}
+
+	struct Bin {
+		qint64 count = 0;
+		qint64 red = 0, green = 0, blue = 0;
+	};
+
+	// Runs task(first, last) over [0, count) in chunks of chunkSize on the pool
+	template<typename Task>
+	void parallelFor(QThreadPool& pool, int count, int chunkSize, Task task) {
+		for (int first = 0; first < count; first += chunkSize) {
+			const int last = qMin(first + chunkSize, count);
+			pool.start([&task, first, last]() { task(first, last); });
+		}
+		pool.waitForDone();
+	}
+}
+
+QList<QRgb> ImageTracer::quantize(const QImage& source, int maxColors) {
+	const QImage image = source.convertToFormat(QImage::Format_ARGB32);
+	const int bands = (image.height() + ROW_BAND - 1) / ROW_BAND;
+
+	// Every band counts into its own histogram, they're added up afterwards
+	std::vector<std::vector<Bin>> bandBins(bands, std::vector<Bin>(4096));
+	QThreadPool pool;
+	pool.setMaxThreadCount(QThread::idealThreadCount());
+	parallelFor(pool, bands, 1, [&](int first, int last) {
+		for (int band = first; band < last; band++) {
+			std::vector<Bin>& bins = bandBins[band];
+			const int endRow = qMin(image.height(), (band + 1) * ROW_BAND);
+			for (int y = band * ROW_BAND; y < endRow; y++) {
+				const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+				for (int x = 0; x < image.width(); x++) {
+					if (qAlpha(line[x]) < 128) continue;
+					Bin& bin = bins[histogramBin(line[x])];
+					bin.count++;
+					bin.red += qRed(line[x]);
+					bin.green += qGreen(line[x]);
+					bin.blue += qBlue(line[x]);
+				}
+			}
+		}
+	});
+
+	std::vector<Bin> bins(4096);
+	for (const std::vector<Bin>& band : bandBins) {
+		for (int i = 0; i < 4096; i++) {
+			bins[i].count += band[i].count;
+			bins[i].red += band[i].red;
+			bins[i].green += band[i].green;
+			bins[i].blue += band[i].blue;
+		}
+	}
+
+	// Most populated bins first, each becomes a color unless one close to it was taken already
+	std::vector<int> order;
+	for (int i = 0; i < 4096; i++) {
+		if (bins[i].count > 0) order.push_back(i);
+	}
+	std::sort(order.begin(), order.end(), [&](int a, int b) { return bins[a].count > bins[b].count; });
+
+	QList<QRgb> palette;
+	for (int index : order) {
+		if (palette.size() >= maxColors) break;
+
+		const Bin& bin = bins[index];
+		const QRgb color = qRgb(bin.red / bin.count, bin.green / bin.count, bin.blue / bin.count);
+		const bool distinct = std::none_of(palette.begin(), palette.end(),
+			[color](QRgb other) { return colorDistance(color, other) < MIN_COLOR_DISTANCE; });
+		if (distinct) palette.append(color);
+	}
+	return palette;
+}
+
+QList<StrokeItem*> ImageTracer::trace(const RasterItem& raster, const ImageTraceOptions& options) {
+	const QImage image = raster.image().convertToFormat(QImage::Format_ARGB32);
+	const QList<QRgb> palette = quantize(image, qBound(1, options.maxColors, static_cast<int>(NO_COLOR)));
+	if (image.isNull() || palette.isEmpty()) return {};
+
+	const int width = image.width();
+	const int height = image.height();
+
+	// Nearest palette color for every histogram bin, so labeling is one lookup per pixel
+	std::vector<quint8> binColor(4096);
+	for (int i = 0; i < 4096; i++) {
+		const QRgb binCenter = qRgb(((i >> 8) << 4) + 8, (((i >> 4) & 15) << 4) + 8, ((i & 15) << 4) + 8);
+		int best = 0;
+		for (int c = 1; c < palette.size(); c++) {
+			if (colorDistance(binCenter, palette[c]) < colorDistance(binCenter, palette[best])) best = c;
+		}
+		binColor[i] = static_cast<quint8>(best);
+	}
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(QThread::idealThreadCount());
+
+	std::vector<quint8> labels(static_cast<size_t>(width) * height);
+	parallelFor(pool, height, ROW_BAND, [&](int first, int last) {
+		for (int y = first; y < last; y++) {
+			const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+			quint8* row = labels.data() + static_cast<size_t>(y) * width;
+			for (int x = 0; x < width; x++) {
+				row[x] = qAlpha(line[x]) < 128 ? NO_COLOR : binColor[histogramBin(line[x])];
+			}
+		}
+	});
+
+	// Outlines are built in the raster's item coordinates
+	const QRectF target = raster.path().boundingRect();
+	const QSizeF pixelSize(target.width() / width, target.height() / height);
+
+	const int tileSize = qMax(16, options.tileSize);
+	const int tilesX = (width + tileSize - 1) / tileSize;
+	const int tilesY = (height + tileSize - 1) / tileSize;
+	const int tileCount = tilesX * tilesY;
+	const int firstColor = options.skipBackground && palette.size() > 1 ? 1 : 0;
+	const int colorCount = palette.size() - firstColor;
+
+	// One task per color and tile, spans cut at tile borders are joined again in the merge
+	std::vector<Clipper2Lib::Paths64> tileOutlines(static_cast<size_t>(colorCount) * tileCount);
+	parallelFor(pool, colorCount * tileCount, 1, [&](int first, int last) {
+		std::vector<PixelSpan> spans;
+		for (int task = first; task < last; task++) {
+			const quint8 color = static_cast<quint8>(firstColor + task / tileCount);
+			const int tile = task % tileCount;
+			const int left = (tile % tilesX) * tileSize;
+			const int top = (tile / tilesX) * tileSize;
+			const int right = qMin(width, left + tileSize);
+			const int bottom = qMin(height, top + tileSize);
+
+			spans.clear();
+			for (int y = top; y < bottom; y++) {
+				const quint8* row = labels.data() + static_cast<size_t>(y) * width;
+				DrawingEngineUtils::appendRowSpans(y, left, right,
+					[row, color](int x) { return row[x] == color; }, spans);
+			}
+			if (!spans.empty()) {
+				tileOutlines[task] = DrawingEngineUtils::unionSpans(spans.data(), spans.size(), target.topLeft(), pixelSize);
+			}
+		}
+	});
+
+	// Merge the tiles of every color and straighten the pixel staircases
+	const double epsilon = options.tolerance * qMax(pixelSize.width(), pixelSize.height()) * CLIPPER_SCALING;
+	std::vector<Clipper2Lib::Paths64> colorOutlines(colorCount);
+	parallelFor(pool, colorCount, 1, [&](int first, int last) {
+		for (int color = first; color < last; color++) {
+			Clipper2Lib::Clipper64 clipper;
+			for (int tile = 0; tile < tileCount; tile++) {
+				const Clipper2Lib::Paths64& outlines = tileOutlines[static_cast<size_t>(color) * tileCount + tile];
+				if (!outlines.empty()) clipper.AddSubject(outlines);
+			}
+
+			Clipper2Lib::Paths64 merged;
+			clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, merged);
+			Clipper2Lib::Paths64 simplified = epsilon > 0 ? Clipper2Lib::SimplifyPaths(merged, epsilon) : std::move(merged);
+			simplified.erase(std::remove_if(simplified.begin(), simplified.end(),
+				[](const Clipper2Lib::Path64& path) { return path.size() < 3; }), simplified.end());
+			colorOutlines[color] = std::move(simplified);
+		}
+	});
+
+	const std::shared_ptr<StrokeStyleTable> styles = StrokeStyleTable::forScene(raster.scene());
+	QList<StrokeItem*> items;
+	for (int color = 0; color < colorCount; color++) {
+		if (colorOutlines[color].empty()) continue;
+
+		StrokeItem* item = new StrokeItem(QColor(palette[firstColor + color]), styles);
+		item->setClipperPaths(colorOutlines[color]);
+		item->setTransform(raster.transform());
+		item->setPos(raster.pos());
+		item->setZValue(raster.zValue());
+		items.append(item);
+	}
+	return items;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+#include <QtWidgets>
+#include "RasterItem.h"
+#include "StrokeItem.h"
+
+struct ImageTraceOptions {
+	int maxColors = 8;           // Colors the image is reduced to
+	bool skipBackground = true;  // Leave out the most common color, the paper of a scan
+	double tolerance = 0.75;     // How far outlines may move when simplified, in image pixels
+	int tileSize = 512;          // Regions are extracted per tile and color in parallel
+};
+
+// Turns a RasterItem into filled StrokeItems, one per color. The image is
+// reduced to a small palette, the pixels of every color become spans that are
+// unioned into outlines per tile, then the tiles of a color are merged and
+// simplified with Clipper2. Tiles and colors are traced on a thread pool.
+class ImageTracer {
+public:
+	// The items are placed over the raster, ready to be added to its scene
+	static QList<StrokeItem*> trace(const RasterItem& raster, const ImageTraceOptions& options = ImageTraceOptions());
+
+	// Palette of the image, most common color first. Transparent pixels are ignored.
+	static QList<QRgb> quantize(const QImage& image, int maxColors);
+};
\ No newline at end of file
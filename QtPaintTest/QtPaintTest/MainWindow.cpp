@@ -2,20 +2,30 @@
 #include "FileIOOperations.h"
 #include "ManipulatableGraphicsView.h"
 #include "DrawingManager.h"
+#include "HistoryStore.h"
+#include "AddFrameCommand.h"
+#include "RemoveFrameCommand.h"
+#include "AddItemsCommand.h"
+#include "RemoveItemsCommand.h"
+#include "ImageImporter.h"
+#include "PerfMonitor.h"
+#include "StrokeFinalizer.h"
 
 MainWindow::MainWindow() : m_currentFrame(0) {
-    // Create the undo stack first
-    m_undoStack = new QUndoStack(this);
-	DrawingManager::getInstance().setUndoStack(m_undoStack);
+    // Create the undo group first, every frame brings its own stack
+    m_undoGroup = new QUndoGroup(this);
+    m_projectUndoStack = new QUndoStack(this);
 
     // Create initial frames (3 instead of just 1)
     for (int i = 0; i < 3; i++) {
         DrawingScene* scene = new DrawingScene();
-        scene->setSceneRect(-500, -500, 1000, 1000);
+        scene->setSceneRect(DEFAULT_SCENE_RECT);
         scene->setBackgroundBrush(Qt::white);
-        //scene->setUndoStack(m_undoStack); // Set the undo stack for each scene
+        m_undoGroup->addStack(scene->undoStack());
         m_frames.append(scene);
     }
+    m_undoGroup->setActiveStack(m_frames[m_currentFrame]->undoStack());
+	DrawingManager::getInstance().setUndoStack(m_frames[m_currentFrame]->undoStack());
 	DrawingManager::getInstance().setScene(m_frames[m_currentFrame]);
 
     setupUI();
@@ -32,6 +42,8 @@ MainWindow::MainWindow() : m_currentFrame(0) {
 }
 
 MainWindow::~MainWindow() {
+    // The frames take their undo stacks with them
+    DrawingManager::getInstance().setUndoStack(nullptr);
     qDeleteAll(m_frames);
 }
 
@@ -323,6 +335,12 @@ void MainWindow::setupMenus() {
     importImageAction->setShortcut(QKeySequence("Ctrl+I"));
     connect(importImageAction, &QAction::triggered, this, &MainWindow::importImage);
 
+    QAction* importVectorAction = fileMenu->addAction("Import &Vector File...");
+    importVectorAction->setShortcut(QKeySequence("Ctrl+Shift+I"));
+    connect(importVectorAction, &QAction::triggered, this, [this]() {
+        FileIOOperations::importVectorFile(*m_frames[m_currentFrame], *this);
+        });
+
     fileMenu->addSeparator();
 
     // Export submenu
@@ -343,6 +361,28 @@ void MainWindow::setupMenus() {
         FileIOOperations::exportJPEG(*m_frames[m_currentFrame], *this);
         });
 
+    exportMenu->addSeparator();
+
+    QAction* exportPNGSequence = exportMenu->addAction("Export Frames as PNG Se&quence...");
+    connect(exportPNGSequence, &QAction::triggered, this, [this]() {
+        FileIOOperations::exportAnimation(m_frames, m_timeline->getFrameRate(), FrameExportFormat::PNG, *this);
+        });
+
+    QAction* exportJPEGSequence = exportMenu->addAction("Export Frames as JPEG Seq&uence...");
+    connect(exportJPEGSequence, &QAction::triggered, this, [this]() {
+        FileIOOperations::exportAnimation(m_frames, m_timeline->getFrameRate(), FrameExportFormat::JPEG, *this);
+        });
+
+    QAction* exportAPNG = exportMenu->addAction("Export as &Animated PNG...");
+    connect(exportAPNG, &QAction::triggered, this, [this]() {
+        FileIOOperations::exportAnimation(m_frames, m_timeline->getFrameRate(), FrameExportFormat::APNG, *this);
+        });
+
+    QAction* exportAnimatedSVG = exportMenu->addAction("Export Animation as S&VG...");
+    connect(exportAnimatedSVG, &QAction::triggered, this, [this]() {
+        FileIOOperations::exportAnimatedSVG(m_frames, m_timeline->getFrameRate(), *this);
+        });
+
     fileMenu->addSeparator();
 
     // Exit action
@@ -351,19 +391,30 @@ void MainWindow::setupMenus() {
     connect(exitAction, &QAction::triggered, this, &QWidget::close);
 }
 void MainWindow::setupTools() {
-    m_frames[m_currentFrame]->setSceneRect(-500, -500, 1000, 1000);
+    m_frames[m_currentFrame]->setSceneRect(DEFAULT_SCENE_RECT);
     m_frames[m_currentFrame]->setBackgroundBrush(Qt::white);
 }
 void MainWindow::setupUndoRedo() {
     // Create undo/redo actions
-    m_undoAction = m_undoStack->createUndoAction(this, tr("&Undo"));
+    m_undoAction = m_undoGroup->createUndoAction(this, tr("&Undo"));
     m_undoAction->setShortcut(QKeySequence::Undo);
     m_undoAction->setIcon(QIcon::fromTheme("edit-undo"));
 
-    m_redoAction = m_undoStack->createRedoAction(this, tr("&Redo"));
+    m_redoAction = m_undoGroup->createRedoAction(this, tr("&Redo"));
     m_redoAction->setShortcut(QKeySequence::Redo);
     m_redoAction->setIcon(QIcon::fromTheme("edit-redo"));
 
+    // Strokes still being finished go onto the history first, so undo takes the latest one
+    for (QAction* action : { m_undoAction, m_redoAction }) {
+        const bool isUndo = action == m_undoAction;
+        disconnect(action, &QAction::triggered, m_undoGroup, nullptr);
+        connect(action, &QAction::triggered, m_undoGroup, [this, isUndo]() {
+            StrokeFinalizer::getInstance().finishPending();
+            if (isUndo) m_undoGroup->undo();
+            else m_undoGroup->redo();
+            });
+    }
+
     // Get or create Edit menu
     QMenu* editMenu = nullptr;
     for (QAction* action : menuBar()->actions()) {
@@ -412,6 +463,89 @@ void MainWindow::setupUndoRedo() {
         }
     }
 
+    // Adding and removing frames has its own history, independent of the frames' contents
+    QAction* frameUndoAction = m_projectUndoStack->createUndoAction(this, tr("Undo Frame Change"));
+    frameUndoAction->setShortcut(QKeySequence("Ctrl+Alt+Z"));
+    editMenu->addAction(frameUndoAction);
+    QAction* frameRedoAction = m_projectUndoStack->createRedoAction(this, tr("Redo Frame Change"));
+    frameRedoAction->setShortcut(QKeySequence("Ctrl+Alt+Y"));
+    editMenu->addAction(frameRedoAction);
+    editMenu->addSeparator();
+
+    // Memory the undo history may use before old geometry moves to disk
+    QAction* historyBudgetAction = editMenu->addAction(tr("History Memory &Budget..."));
+    connect(historyBudgetAction, &QAction::triggered, this, [this]() {
+        HistoryStore& store = HistoryStore::getInstance();
+        bool ok;
+        int megabytes = QInputDialog::getInt(this, tr("History Memory Budget"),
+            tr("Memory for undo history (MB):"), static_cast<int>(store.memoryBudget() / (1024 * 1024)), 1, 65536, 1, &ok);
+        if (ok) {
+            store.setMemoryBudget(static_cast<qint64>(megabytes) * 1024 * 1024);
+            statusBar()->showMessage(tr("History uses %1 MB in memory, %2 MB on disk")
+                .arg(store.memoryUsage() / (1024.0 * 1024.0), 0, 'f', 1)
+                .arg(store.diskUsage() / (1024.0 * 1024.0), 0, 'f', 1), 3000);
+        }
+        });
+
+    editMenu->addSeparator();
+
+    // Fewer, bigger items for dense frames, by hand or once the frame has been left alone for a while
+    QAction* mergeAction = editMenu->addAction(tr("&Merge Strokes"));
+    mergeAction->setShortcut(QKeySequence("Ctrl+Shift+M"));
+    connect(mergeAction, &QAction::triggered, this, [this]() {
+        int saved = DrawingManager::getInstance().mergeStrokes();
+        statusBar()->showMessage(tr("Merging removed %1 items").arg(saved), 3000);
+        });
+
+    m_idleMergeAction = editMenu->addAction(tr("Merge Strokes When &Idle"));
+    m_idleMergeAction->setCheckable(true);
+    m_idleMergeTimer = new QTimer(this);
+    m_idleMergeTimer->setSingleShot(true);
+    m_idleMergeTimer->setInterval(IDLE_MERGE_DELAY_MS);
+    connect(m_idleMergeTimer, &QTimer::timeout, this, &MainWindow::mergeStrokesWhenIdle);
+    connect(m_undoGroup, &QUndoGroup::indexChanged, this, [this]() {
+        if (m_idleMergeAction->isChecked()) m_idleMergeTimer->start();
+        });
+    connect(m_idleMergeAction, &QAction::toggled, this, [this](bool enabled) {
+        if (enabled) m_idleMergeTimer->start();
+        else m_idleMergeTimer->stop();
+        });
+
+    // How the brush width follows the pen
+    QMenu* brushMenu = menuBar()->addMenu(tr("&Brush"));
+    QAction* pressureAction = brushMenu->addAction(tr("&Pressure Sensitivity"));
+    pressureAction->setCheckable(true);
+    pressureAction->setChecked(DrawingManager::getInstance().isPressureSensitive());
+    connect(pressureAction, &QAction::toggled, this, [](bool enabled) {
+        DrawingManager::getInstance().setPressureSensitive(enabled);
+        });
+
+    QAction* velocityAction = brushMenu->addAction(tr("Thinner When &Fast"));
+    velocityAction->setCheckable(true);
+    velocityAction->setChecked(DrawingManager::getInstance().isVelocitySensitive());
+    connect(velocityAction, &QAction::toggled, this, [](bool enabled) {
+        DrawingManager::getInstance().setVelocitySensitive(enabled);
+        });
+
+    // Performance data, for when drawing feels slow
+    QMenu* viewMenu = menuBar()->addMenu(tr("&View"));
+    QAction* overlayAction = viewMenu->addAction(tr("Performance &Overlay"));
+    overlayAction->setCheckable(true);
+    overlayAction->setShortcut(QKeySequence("F12"));
+    connect(overlayAction, &QAction::toggled, m_view, &ManipulatableGraphicsView::setPerformanceOverlay);
+
+    QAction* traceAction = viewMenu->addAction(tr("Save Performance &Trace..."));
+    connect(traceAction, &QAction::triggered, this, [this]() {
+        QString fileName = QFileDialog::getSaveFileName(this, tr("Save Performance Trace"),
+            "trace.json", tr("Chrome Trace (*.json)"));
+        if (fileName.isEmpty()) return;
+
+        QString error;
+        if (!PerfMonitor::getInstance().writeChromeTrace(fileName, &error)) {
+            QMessageBox::warning(this, "Save Error", error);
+        }
+        });
+
     // Toolbar for undo/redo actions
     QToolBar* editToolbar = addToolBar(tr("Edit"));
     editToolbar->addAction(m_undoAction);
@@ -419,7 +553,7 @@ void MainWindow::setupUndoRedo() {
 
     // Create the undo view at the end, after everything else is set up
     QDockWidget* undoDock = new QDockWidget(tr("History"), this);
-    QUndoView* undoView = new QUndoView(m_undoStack);
+    QUndoView* undoView = new QUndoView(m_undoGroup);
     undoDock->setWidget(undoView);
     addDockWidget(Qt::RightDockWidgetArea, undoDock);
 }
@@ -455,18 +589,21 @@ void MainWindow::setBrushSize(int size) {
 }
 
 void MainWindow::onFrameSelected(int frame) {
+    StrokeFinalizer::getInstance().finishPending();
     if (frame >= 0 && frame < m_frames.size()) {
         if (m_view->scene()) {
             disconnect(m_view, &ManipulatableGraphicsView::keyPressedInView, static_cast<DrawingScene*>(m_view->scene()), &DrawingScene::keyPressEvent);
             disconnect(m_view, &ManipulatableGraphicsView::keyReleasedInView, static_cast<DrawingScene*>(m_view->scene()), &DrawingScene::keyReleaseEvent);
         }
 
-        m_undoStack->clear();
-
         m_currentFrame = frame;
         m_view->setScene(m_frames[frame]);
         DrawingManager::getInstance().setScene(m_frames[frame]);
 
+        // Switch to the frame's own history
+        m_undoGroup->setActiveStack(m_frames[frame]->undoStack());
+        DrawingManager::getInstance().setUndoStack(m_frames[frame]->undoStack());
+
         connect(m_view, &ManipulatableGraphicsView::keyPressedInView, m_frames[frame], &DrawingScene::keyPressEvent);
         connect(m_view, &ManipulatableGraphicsView::keyReleasedInView, m_frames[frame], &DrawingScene::keyReleaseEvent);
 
@@ -483,71 +620,52 @@ void MainWindow::onFrameSelected(int frame) {
 }
 
 void MainWindow::onAddFrame() {
-    // Remember whether onion skin is enabled
-    bool wasOnionSkinEnabled = m_onionSkinEnabled;
-    // Disable onion skin temporarily
-    if (m_onionSkinEnabled) {
-        toggleOnionSkin(false);
-    }
+    // The new frame shares the geometry of the current one
+    DrawingScene* newScene = m_frames[m_currentFrame]->duplicate();
 
-    // Create new scene
-    DrawingScene* newScene = new DrawingScene();
-    newScene->setSceneRect(-500, -500, 1000, 1000);
-    newScene->setBackgroundBrush(Qt::white);
+    // Insert after current frame (not at the end), on the project history
+    m_projectUndoStack->push(new AddFrameCommand(this, m_currentFrame + 1, newScene));
+}
 
-    // Copy all items from current scene to new scene
-    foreach(QGraphicsItem * item, m_frames[m_currentFrame]->items()) {
-        // Specifically look for StrokeItem objects
-        if (StrokeItem* strokeItem = dynamic_cast<StrokeItem*>(item)) {
-            // Use the clone method for proper deep copying
-            StrokeItem* newStrokeItem = strokeItem->clone();
-            newScene->addItem(newStrokeItem);
-        }
+void MainWindow::onRemoveFrame() {
+    if (m_frames.size() > 1) {
+        m_projectUndoStack->push(new RemoveFrameCommand(this, m_currentFrame));
     }
+}
 
+void MainWindow::insertFrame(int index, DrawingScene* frame) {
     // Reset selection state to ensure proper initialization
-    //newScene->resetSelectionState();
     if (DrawingManager::getInstance().getCurrentTool()->toolName() == "Select") {
-        // Cast to SelectTool and reset selection
         SelectTool* selectTool = dynamic_cast<SelectTool*>(DrawingManager::getInstance().getCurrentTool());
         if (selectTool) {
             selectTool->resetSelectionState();
         }
     }
 
-    // Insert after current frame (not at the end)
-    m_frames.insert(m_currentFrame + 1, newScene);
+    m_frames.insert(index, frame);
+    m_undoGroup->addStack(frame->undoStack());
 
     // Select the new frame
-    m_currentFrame = m_currentFrame + 1;
-
-    // Connect key event handling to the new frame
-    connect(m_view, &ManipulatableGraphicsView::keyPressedInView, m_frames[m_currentFrame], &DrawingScene::keyPressEvent);
-    connect(m_view, &ManipulatableGraphicsView::keyReleasedInView, m_frames[m_currentFrame], &DrawingScene::keyReleaseEvent);
-
-    // Update the timeline and view
-    m_timeline->setFrames(m_frames.size(), m_currentFrame);
-    m_view->setScene(m_frames[m_currentFrame]);
-    DrawingManager::getInstance().setScene(m_frames[m_currentFrame]);
-
-    // Re-enable onion skin if it was previously enabled
-    if (wasOnionSkinEnabled) {
-        toggleOnionSkin(true);
-    }
+    onFrameSelected(index);
 }
 
-void MainWindow::onRemoveFrame() {
-    if (m_frames.size() > 1) {
-        delete m_frames.takeAt(m_currentFrame);
-        m_currentFrame = qMin(m_currentFrame, m_frames.size() - 1);
-        m_timeline->setFrames(m_frames.size(), m_currentFrame);
-        m_view->setScene(m_frames[m_currentFrame]);
-        DrawingManager::getInstance().setScene(m_frames[m_currentFrame]);
+DrawingScene* MainWindow::takeFrame(int index) {
+    // Onion skins live in the current frame and must not leave with it
+    clearOnionSkin();
 
-        if (m_onionSkinEnabled) {
-            updateOnionSkin();
+    // Reset selection state, the selection may belong to the frame being taken out
+    if (DrawingManager::getInstance().getCurrentTool()->toolName() == "Select") {
+        SelectTool* selectTool = dynamic_cast<SelectTool*>(DrawingManager::getInstance().getCurrentTool());
+        if (selectTool) {
+            selectTool->resetSelectionState();
         }
     }
+
+    DrawingScene* frame = m_frames.takeAt(index);
+    m_undoGroup->removeStack(frame->undoStack());
+
+    onFrameSelected(qMin(index, m_frames.size() - 1));
+    return frame;
 }
 
 
@@ -586,38 +704,71 @@ void MainWindow::setOnionSkinOpacity(int opacity) {
 
 void MainWindow::importImage() {
     // Create file dialog for selecting images
-    QString fileName = QFileDialog::getOpenFileName(this,
+    QStringList fileNames = QFileDialog::getOpenFileNames(this,
         tr("Import Image"),
         QString(),
         tr("Image Files (*.png *.jpg *.jpeg)"));
 
-    if (fileName.isEmpty())
+    if (fileNames.isEmpty())
         return;
 
-    // Create a RasterItem with the selected image
-    RasterItem* imageItem = new RasterItem(fileName);
+    // Only the headers are read here, the images are decoded in the background
+    // and show up in their placeholders when ready
+    DrawingScene* scene = m_frames[m_currentFrame];
+    QString error;
+    QList<RasterItem*> imageItems = ImageImporter::importImages(fileNames, scene, &error,
+        [this, scene](const QList<RasterItem*>& placeholders, const QString& decodeError) {
+            // The header was fine but the pixels weren't, the placeholder goes again.
+            // Onto the history of the frame it's in, which needn't be the current one anymore.
+            if (!placeholders.isEmpty()) {
+                QList<BaseItem*> items(placeholders.begin(), placeholders.end());
+                scene->undoStack()->push(new RemoveItemsCommand(scene, items));
+            }
+            QMessageBox::warning(this, "Import Error", decodeError);
+        });
+
+    QList<BaseItem*> items;
+    items.reserve(imageItems.size());
+    for (RasterItem* imageItem : imageItems) {
+        // Center the image in the view
+        QRectF itemRect = imageItem->boundingRect();
+        imageItem->setPos(-itemRect.width() / 2, -itemRect.height() / 2);
+        items.append(imageItem);
+    }
 
-    // Add the RasterItem to the current scene
-    m_frames[m_currentFrame]->addItem(imageItem);
+    if (!items.isEmpty()) {
+        DrawingManager::getInstance().pushCommand(new AddItemsCommand(scene, items));
+    }
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, "Import Error", error);
+    }
+}
 
-    // Center the image in the view
-    QRectF itemRect = imageItem->boundingRect();
-    imageItem->setPos(-itemRect.width() / 2, -itemRect.height() / 2);
+void MainWindow::mergeStrokesWhenIdle() {
+    // Not while playing back or in the middle of a stroke
+    if (m_animationTimer->isActive() || QApplication::mouseButtons() != Qt::NoButton) {
+        m_idleMergeTimer->start();
+        return;
+    }
+    if (m_frames[m_currentFrame]->items().size() < IDLE_MERGE_MIN_ITEMS) return;
 
-    // Create an undo command if needed
-    // For now, we'll just add the item directly
+    // Pushing the merge restarts the timer, the next round finds nothing left to merge
+    int saved = DrawingManager::getInstance().mergeStrokes(true);
+    if (saved > 0) {
+        statusBar()->showMessage(tr("Merging removed %1 items").arg(saved), 3000);
+    }
+}
 
-    // Update the scene
-    m_frames[m_currentFrame]->update();
+void MainWindow::clearOnionSkin() {
+    // Deleting a group also takes it out of whichever frame it was added to
+    qDeleteAll(m_onionSkinItems);
+    m_onionSkinItems.clear();
 }
 
 void MainWindow::updateOnionSkin() {
     // Clear any existing onion skin items
-    for (QGraphicsItemGroup* group : m_onionSkinItems) {
-        m_frames[m_currentFrame]->removeItem(group);
-        delete group;
-    }
-    m_onionSkinItems.clear();
+    clearOnionSkin();
+    StrokeFinalizer::getInstance().finishPending(); // The skins are copies of the other frames' strokes
 
     if (!m_onionSkinEnabled) {
         return;
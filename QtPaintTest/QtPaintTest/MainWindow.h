@@ -1,6 +1,7 @@
 #pragma once
 #include <QtWidgets>
 #include <QUndoStack>
+#include <QUndoGroup>
 #include <QUndoView>
 #include "DrawingScene.h"
 #include "TimelineWidget.h"
@@ -12,6 +13,10 @@ public:
     MainWindow();
     ~MainWindow();
 
+    // Used by the frame commands on the project stack
+    void insertFrame(int index, DrawingScene* frame);
+    DrawingScene* takeFrame(int index);
+
 private slots:
     void onFrameSelected(int frame);
     void onAddFrame();
@@ -22,6 +27,7 @@ private slots:
     void toggleOnionSkin(bool enabled);
     void setOnionSkinOpacity(int opacity);
     void importImage();
+    void mergeStrokesWhenIdle();
 
 private:
     void setupUI();
@@ -48,11 +54,16 @@ private:
     QSlider* m_opacitySlider;
     QCheckBox* m_onionSkinCheckBox;
 
-    // Undo/Redo stack
-    QUndoStack* m_undoStack;
+    // Undo/Redo: one stack per frame, plus one for adding and removing frames
+    QUndoGroup* m_undoGroup;
+    QUndoStack* m_projectUndoStack;
     QAction* m_undoAction;
     QAction* m_redoAction;
 
+    QAction* m_idleMergeAction;
+    QTimer* m_idleMergeTimer;
+
     void updateOnionSkin();
+    void clearOnionSkin();
     void addOnionSkinFrame(int frameIndex, float opacityMultiplier = 1.0f);
 };
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include <QScrollBar>
 #include <QApplication> 
 #include <DrawingScene.h>
+#include "PerfMonitor.h"
+#include "HistoryStore.h"
+#include "DrawingManager.h"
 
 ManipulatableGraphicsView::ManipulatableGraphicsView(QWidget* parent)
     : QGraphicsView(parent), m_isPanning(false) {
@@ -20,6 +23,7 @@ ManipulatableGraphicsView::ManipulatableGraphicsView(QGraphicsScene* scene, QWid
 }
 
 void ManipulatableGraphicsView::wheelEvent(QWheelEvent* event) {
+    PerfMonitor::getInstance().markInput();
     qreal scaleFactor = 1.15;
     if (event->angleDelta().y() > 0) {
         scale(scaleFactor, scaleFactor);
@@ -33,6 +37,7 @@ void ManipulatableGraphicsView::wheelEvent(QWheelEvent* event) {
 }
 
 void ManipulatableGraphicsView::mousePressEvent(QMouseEvent* event) {
+    PerfMonitor::getInstance().markInput();
     // Pan with Middle Mouse Button OR Ctrl + Left Mouse Button
     if ((event->button() == Qt::MiddleButton) ||
         (event->button() == Qt::LeftButton && (QApplication::keyboardModifiers() & Qt::ControlModifier)))
@@ -48,6 +53,10 @@ void ManipulatableGraphicsView::mousePressEvent(QMouseEvent* event) {
 }
 
 void ManipulatableGraphicsView::mouseMoveEvent(QMouseEvent* event) {
+    // Hovering doesn't repaint anything, it would only leave a mark open until something else does
+    if (event->buttons() != Qt::NoButton) {
+        PerfMonitor::getInstance().markInput();
+    }
     if (m_isPanning) {
         QPoint delta = event->pos() - m_panStartPos;
         horizontalScrollBar()->setValue(horizontalScrollBar()->value() - delta.x());
@@ -61,6 +70,7 @@ void ManipulatableGraphicsView::mouseMoveEvent(QMouseEvent* event) {
 }
 
 void ManipulatableGraphicsView::mouseReleaseEvent(QMouseEvent* event) {
+    PerfMonitor::getInstance().markInput();
     if (m_isPanning && (event->button() == Qt::MiddleButton || event->button() == Qt::LeftButton)) {
         m_isPanning = false;
         setCursor(Qt::ArrowCursor);
@@ -71,7 +81,26 @@ void ManipulatableGraphicsView::mouseReleaseEvent(QMouseEvent* event) {
     }
 }
 
+bool ManipulatableGraphicsView::viewportEvent(QEvent* event) {
+    switch (event->type()) {
+    case QEvent::TabletPress:
+    case QEvent::TabletMove:
+    case QEvent::TabletRelease: {
+        // Only the pressure is taken, the event is left unhandled so Qt sends
+        // the matching mouse event and the tools see the pen like a mouse
+        QTabletEvent* tablet = static_cast<QTabletEvent*>(event);
+        const bool penDown = event->type() != QEvent::TabletRelease && tablet->buttons() != Qt::NoButton;
+        DrawingManager::getInstance().setTabletPressure(tablet->pressure(), penDown);
+        event->ignore();
+        return false;
+    }
+    default:
+        return QGraphicsView::viewportEvent(event);
+    }
+}
+
 void ManipulatableGraphicsView::keyPressEvent(QKeyEvent* event) {
+    PerfMonitor::getInstance().markInput();
     emit keyPressedInView(event);
     if (!event->isAccepted()) {
         QGraphicsView::keyPressEvent(event);
@@ -83,4 +112,87 @@ void ManipulatableGraphicsView::keyReleaseEvent(QKeyEvent* event) {
     if (!event->isAccepted()) {
         QGraphicsView::keyReleaseEvent(event);
     }
+}
+
+void ManipulatableGraphicsView::paintEvent(QPaintEvent* event) {
+    Timer timer;
+    {
+        PerfScope scope("view/paint");
+        QGraphicsView::paintEvent(event);
+    }
+    PerfMonitor::getInstance().markPainted(timer.elapsed_nano());
+}
+
+void ManipulatableGraphicsView::setPerformanceOverlay(bool enabled) {
+    PerfMonitor::getInstance().setOverlayEnabled(enabled);
+    if (enabled && !m_overlayTimer) {
+        // The numbers refresh twice a second, only the overlay's corner is repainted for it
+        m_overlayTimer = new QTimer(this);
+        m_overlayTimer->setInterval(500);
+        connect(m_overlayTimer, &QTimer::timeout, this, &ManipulatableGraphicsView::updateOverlayText);
+    }
+    if (m_overlayTimer) {
+        if (enabled) m_overlayTimer->start();
+        else m_overlayTimer->stop();
+    }
+    updateOverlayText();
+    viewport()->update();
+}
+
+void ManipulatableGraphicsView::updateOverlayText() {
+    m_overlayLines.clear();
+    if (!PerfMonitor::getInstance().isOverlayEnabled()) return;
+
+    const PerfMonitor::Summary summary = PerfMonitor::getInstance().summary();
+    const HistoryStore& history = HistoryStore::getInstance();
+    auto ms = [](qint64 ns) { return QString::number(ns / 1.0e6, 'f', 1) + " ms"; };
+
+    m_overlayLines << "Frame: " + ms(summary.frameTime)
+        << "Input to paint: " + ms(summary.inputLatency) + " (worst " + ms(summary.worstLatency) + ")"
+        << QString("Items: %1").arg(scene() ? scene()->items().size() : 0)
+        << QString("History: %1 MB, %2 MB on disk")
+            .arg(history.memoryUsage() / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(history.diskUsage() / (1024.0 * 1024.0), 0, 'f', 1);
+    for (const auto& slowest : summary.slowest) {
+        m_overlayLines << "  " + slowest.first + ": " + ms(slowest.second);
+    }
+
+    viewport()->update(m_overlayRect);
+    const QFontMetrics metrics(font());
+    int width = 0;
+    for (const QString& line : m_overlayLines) width = qMax(width, metrics.horizontalAdvance(line));
+    m_overlayRect = QRect(8, 8, width + 16, metrics.height() * m_overlayLines.size() + 12);
+    viewport()->update(m_overlayRect);
+}
+
+void ManipulatableGraphicsView::scrollContentsBy(int dx, int dy) {
+    QGraphicsView::scrollContentsBy(dx, dy);
+    if (m_overlayLines.isEmpty()) return;
+
+    // Scrolling blits the viewport, the overlay has to be repainted where it
+    // stays and where the blit dragged its old pixels to
+    viewport()->update(m_overlayRect);
+    viewport()->update(m_overlayRect.translated(dx, dy));
+}
+
+void ManipulatableGraphicsView::drawForeground(QPainter* painter, const QRectF& rect) {
+    QGraphicsView::drawForeground(painter, rect);
+    if (m_overlayLines.isEmpty()) return;
+
+    // Drawn in viewport pixels, whatever the zoom
+    painter->save();
+    painter->resetTransform();
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(QColor(0, 0, 0, 160));
+    painter->drawRoundedRect(m_overlayRect, 4, 4);
+
+    painter->setPen(Qt::white);
+    painter->setFont(font());
+    const int lineHeight = painter->fontMetrics().height();
+    int y = m_overlayRect.top() + 6 + painter->fontMetrics().ascent();
+    for (const QString& line : m_overlayLines) {
+        painter->drawText(m_overlayRect.left() + 8, y, line);
+        y += lineHeight;
+    }
+    painter->restore();
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <QWheelEvent>
 #include <QMouseEvent>
 #include <QKeyEvent>  
+#include <QTabletEvent>
+#include <QTimer>
 
 class ManipulatableGraphicsView : public QGraphicsView {
     Q_OBJECT
@@ -12,6 +14,9 @@ public:
     ManipulatableGraphicsView(QWidget* parent = nullptr);
     ManipulatableGraphicsView(QGraphicsScene* scene, QWidget* parent = nullptr);
 
+    // Frame time, input latency, item counts and history memory in the corner of the view
+    void setPerformanceOverlay(bool enabled);
+
 signals:
     void keyPressedInView(QKeyEvent* event);
     void keyReleasedInView(QKeyEvent* event);
@@ -23,8 +28,18 @@ protected:
     void mouseReleaseEvent(QMouseEvent* event) override;
     void keyPressEvent(QKeyEvent* event) override;
     void keyReleaseEvent(QKeyEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    bool viewportEvent(QEvent* event) override;
+    void drawForeground(QPainter* painter, const QRectF& rect) override;
+    void scrollContentsBy(int dx, int dy) override;
 
 private:
+    void updateOverlayText();
+
+    QTimer* m_overlayTimer = nullptr;
+    QStringList m_overlayLines;
+    QRect m_overlayRect;
+
     bool m_isPanning;
     QPoint m_panStartPos;
 };
\ No newline at end of file
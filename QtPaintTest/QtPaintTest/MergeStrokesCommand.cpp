@@ -0,0 +1,45 @@
+#include "MergeStrokesCommand.h"
+
+// MergeStrokesCommand Implementation
+MergeStrokesCommand::MergeStrokesCommand(DrawingScene* scene,
+    const QList<StrokeItem*>& originals,
+    const QList<StrokeItem*>& merged,
+    QUndoCommand* parent) : QUndoCommand(parent), myScene(scene),
+    originalItems(originals.begin(), originals.end()), mergedItems(merged.begin(), merged.end())
+{
+    for (BaseItem* item : originalItems) item->retainHistory();
+    for (BaseItem* item : mergedItems) item->retainHistory();
+    setText(QString("Merge %1 Shapes into %2").arg(originals.size()).arg(merged.size()));
+}
+
+// Whichever side is outside the scene is deleted once no other command refers to it
+MergeStrokesCommand::~MergeStrokesCommand() {
+    for (BaseItem* item : originalItems) item->releaseHistory();
+    for (BaseItem* item : mergedItems) item->releaseHistory();
+}
+
+void MergeStrokesCommand::undo() {
+    if (!myScene) return;
+
+    myScene->removeItems(mergedItems);
+    for (BaseItem* item : mergedItems) {
+        item->dehydrate();
+    }
+    for (BaseItem* item : originalItems) {
+        item->rehydrate();
+    }
+    myScene->addItems(originalItems);
+}
+
+void MergeStrokesCommand::redo() {
+    if (!myScene) return;
+
+    myScene->removeItems(originalItems);
+    for (BaseItem* item : originalItems) {
+        item->dehydrate();
+    }
+    for (BaseItem* item : mergedItems) {
+        item->rehydrate();
+    }
+    myScene->addItems(mergedItems);
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+#include <QtWidgets>
+#include "DrawingScene.h"
+#include "StrokeItem.h"
+
+// Swaps a set of strokes for the fewer items they were merged into, as a single undo step
+class MergeStrokesCommand : public QUndoCommand {
+public:
+    MergeStrokesCommand(DrawingScene* scene,
+        const QList<StrokeItem*>& originals,
+        const QList<StrokeItem*>& merged,
+        QUndoCommand* parent = nullptr);
+    ~MergeStrokesCommand();
+    void undo() override;
+    void redo() override;
+private:
+    DrawingScene* myScene;
+    QList<BaseItem*> originalItems; // Items before the merge
+    QList<BaseItem*> mergedItems;   // Items after the merge
+};
\ No newline at end of file
@@ -7,13 +7,15 @@ MoveCommand::MoveCommand(DrawingScene* scene,
     QUndoCommand* parent)
     : QUndoCommand(parent), myScene(scene), movedItems(items), delta(moveDelta)
 {
+    // Keeps the items alive while an older command that added them is pruned
+    for (BaseItem* item : movedItems) item->retainHistory();
     setText(QString("Move %1 shape(s)").arg(items.size()));
     timestamp = QTime::currentTime();
 }
 
 
 MoveCommand::~MoveCommand() {
-    // Items are managed by the scene, nothing to delete here
+    for (BaseItem* item : movedItems) item->releaseHistory();
 }
 
 void MoveCommand::redo() {
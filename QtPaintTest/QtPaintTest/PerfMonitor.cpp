@@ -0,0 +1,128 @@
+#include "PerfMonitor.h"
+#include <algorithm>
+
+namespace {
+	// Small per-thread numbers read better in a trace than native thread ids
+	quint32 threadNumber() {
+		static std::atomic<quint32> next{ 1 };
+		static thread_local quint32 number = next.fetch_add(1, std::memory_order_relaxed);
+		return number;
+	}
+
+	const qint64 SUMMARY_WINDOW = 1000000000; // 1 s
+	const int SLOWEST_SHOWN = 5;
+}
+
+PerfMonitor::PerfMonitor()
+	: m_ring(new Sample[CAPACITY]), m_epoch(std::chrono::steady_clock::now()) {
+}
+
+qint64 PerfMonitor::now() const {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+void PerfMonitor::record(const char* name, qint64 start, qint64 duration) {
+	const quint64 index = m_next.fetch_add(1, std::memory_order_relaxed);
+	Sample& sample = m_ring[index & (CAPACITY - 1)];
+
+	// Readers skip the slot while it's being rewritten
+	sample.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	sample.name.store(name, std::memory_order_relaxed);
+	sample.start.store(start, std::memory_order_relaxed);
+	sample.duration.store(duration, std::memory_order_relaxed);
+	sample.thread.store(threadNumber(), std::memory_order_relaxed);
+	sample.sequence.store(index + 1, std::memory_order_release);
+}
+
+QList<PerfMonitor::Copy> PerfMonitor::samples() const {
+	const quint64 end = m_next.load(std::memory_order_acquire);
+	const quint64 begin = end > static_cast<quint64>(CAPACITY) ? end - CAPACITY : 0;
+
+	QList<Copy> copies;
+	copies.reserve(static_cast<qsizetype>(end - begin));
+	for (quint64 index = begin; index < end; index++) {
+		const Sample& sample = m_ring[index & (CAPACITY - 1)];
+		if (sample.sequence.load(std::memory_order_acquire) != index + 1) continue;
+
+		Copy copy{ sample.name.load(std::memory_order_relaxed), sample.start.load(std::memory_order_relaxed),
+			sample.duration.load(std::memory_order_relaxed), sample.thread.load(std::memory_order_relaxed) };
+
+		// Only kept if no writer got to the slot while it was copied
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (sample.sequence.load(std::memory_order_relaxed) != index + 1 || !copy.name) continue;
+		copies.append(copy);
+	}
+	return copies;
+}
+
+void PerfMonitor::markInput() {
+	// Only the first input since the last paint counts, that's the one that waited longest
+	qint64 none = -1;
+	m_pendingInput.compare_exchange_strong(none, now(), std::memory_order_relaxed);
+}
+
+void PerfMonitor::markPainted(qint64 paintDuration) {
+	m_frameTime.store(paintDuration, std::memory_order_relaxed);
+
+	const qint64 input = m_pendingInput.exchange(-1, std::memory_order_relaxed);
+	if (input >= 0) {
+		const qint64 latency = now() - input;
+		m_inputLatency.store(latency, std::memory_order_relaxed);
+		record("input-to-paint", input, latency);
+	}
+}
+
+PerfMonitor::Summary PerfMonitor::summary() const {
+	Summary summary;
+	summary.frameTime = m_frameTime.load(std::memory_order_relaxed);
+	summary.inputLatency = m_inputLatency.load(std::memory_order_relaxed);
+
+	// Worst time per scope name over the last second
+	const qint64 since = now() - SUMMARY_WINDOW;
+	QHash<const char*, qint64> worst;
+	for (const Copy& sample : samples()) {
+		if (sample.start + sample.duration < since) continue;
+		qint64& slowest = worst[sample.name];
+		slowest = qMax(slowest, sample.duration);
+	}
+	for (auto it = worst.cbegin(); it != worst.cend(); ++it) {
+		if (qstrcmp(it.key(), "input-to-paint") == 0) {
+			summary.worstLatency = it.value();
+		}
+		else {
+			summary.slowest.append({ QString::fromLatin1(it.key()), it.value() });
+		}
+	}
+	std::sort(summary.slowest.begin(), summary.slowest.end(),
+		[](const auto& a, const auto& b) { return a.second > b.second; });
+	if (summary.slowest.size() > SLOWEST_SHOWN) summary.slowest.resize(SLOWEST_SHOWN);
+	return summary;
+}
+
+bool PerfMonitor::writeChromeTrace(const QString& fileName, QString* errorString) const {
+	// Complete events ("X"), times are in microseconds
+	QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	for (const Copy& sample : samples()) {
+		if (!first) json += ",\n";
+		first = false;
+		json += "{\"name\":\"";
+		json += sample.name;
+		json += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+		json += QByteArray::number(sample.thread);
+		json += ",\"ts\":";
+		json += QByteArray::number(sample.start / 1000.0, 'f', 3);
+		json += ",\"dur\":";
+		json += QByteArray::number(sample.duration / 1000.0, 'f', 3);
+		json += "}";
+	}
+	json += "\n]}\n";
+
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+		if (errorString) *errorString = file.errorString();
+		return false;
+	}
+	return true;
+}
\ No newline at end of file
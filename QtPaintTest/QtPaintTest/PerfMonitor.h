@@ -0,0 +1,92 @@
+#pragma once
+#include <QtWidgets>
+#include <atomic>
+#include <memory>
+#include "Utils/Timer.h"
+
+// Always-on timing of the hot paths. Scopes write into a fixed ring of samples
+// without locking, so recording costs a clock read and a few stores and can be
+// left enabled in release builds. The ring can be dumped as a Chrome trace
+// (chrome://tracing, Perfetto) and summarized for the view's overlay.
+class PerfMonitor {
+private:
+	PerfMonitor();
+	PerfMonitor(const PerfMonitor&) = delete;
+	PerfMonitor& operator=(const PerfMonitor&) = delete;
+public:
+	static const int CAPACITY = 1 << 16; // Samples kept, older ones are overwritten
+
+	static PerfMonitor& getInstance() {
+		static PerfMonitor instance;
+		return instance;
+	}
+
+	// Nanoseconds since the monitor was created
+	qint64 now() const;
+
+	// name must outlive the monitor, string literals are what the scopes use
+	void record(const char* name, qint64 start, qint64 duration);
+
+	// Input to paint latency: input events mark themselves, the next finished
+	// paint of the view closes the oldest open mark
+	void markInput();
+	void markPainted(qint64 paintDuration);
+
+	struct Summary {
+		qint64 frameTime = 0;     // Last paint of the view, ns
+		qint64 inputLatency = 0;  // Last input to paint latency, ns
+		qint64 worstLatency = 0;  // Worst latency of the last second, ns
+		QList<QPair<QString, qint64>> slowest; // Slowest scopes of the last second by name
+	};
+	Summary summary() const;
+
+	bool writeChromeTrace(const QString& fileName, QString* errorString = nullptr) const;
+
+	bool isOverlayEnabled() const { return m_overlay.load(std::memory_order_relaxed); }
+	void setOverlayEnabled(bool enabled) { m_overlay.store(enabled, std::memory_order_relaxed); }
+
+private:
+	struct Sample {
+		// Published when sequence holds the sample's index plus one, zero while it's written
+		std::atomic<quint64> sequence{ 0 };
+		std::atomic<const char*> name{ nullptr };
+		std::atomic<qint64> start{ 0 };
+		std::atomic<qint64> duration{ 0 };
+		std::atomic<quint32> thread{ 0 };
+	};
+	struct Copy {
+		const char* name;
+		qint64 start;
+		qint64 duration;
+		quint32 thread;
+	};
+	// The samples still in the ring, oldest first
+	QList<Copy> samples() const;
+
+	std::unique_ptr<Sample[]> m_ring;
+	std::atomic<quint64> m_next{ 0 };
+	std::chrono::steady_clock::time_point m_epoch;
+
+	std::atomic<qint64> m_pendingInput{ -1 };
+	std::atomic<qint64> m_frameTime{ 0 };
+	std::atomic<qint64> m_inputLatency{ 0 };
+	std::atomic<bool> m_overlay{ false };
+};
+
+// Times its own lifetime into the PerfMonitor
+class PerfScope {
+public:
+	explicit PerfScope(const char* name)
+		: m_name(name), m_start(PerfMonitor::getInstance().now()) {
+	}
+	~PerfScope() {
+		PerfMonitor::getInstance().record(m_name, m_start, m_timer.elapsed_nano());
+	}
+	PerfScope(const PerfScope&) = delete;
+	PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+	const char* m_name;
+	qint64 m_start;
+	Timer m_timer;
+};
\ No newline at end of file
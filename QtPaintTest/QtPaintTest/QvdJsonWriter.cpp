@@ -0,0 +1,182 @@
+#include "QvdJsonWriter.h"
+#include <QtEndian>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace {
+	const int FLUSH_THRESHOLD = 1 << 16;
+	const int FILE_FORMAT_VERSION = 2;
+}
+
+QvdJsonWriter::QvdJsonWriter(QvdPathEncoding encoding) : m_encoding(encoding) {
+	m_buffer.reserve(2 * FLUSH_THRESHOLD);
+}
+
+void QvdJsonWriter::appendNumber(double value) {
+	// Shortest text that reads back as the same double
+	char text[32];
+	if (!std::isfinite(value)) value = 0; // Not representable in JSON
+	const std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+	m_buffer.append(text, result.ptr - text);
+}
+
+void QvdJsonWriter::appendPackedPath(const QPainterPath& path) {
+	const int count = path.elementCount();
+
+	m_buffer.append(",\"xs\":[");
+	for (int i = 0; i < count; i++) {
+		if (i > 0) m_buffer.append(',');
+		appendNumber(path.elementAt(i).x);
+	}
+	m_buffer.append("],\"ys\":[");
+	for (int i = 0; i < count; i++) {
+		if (i > 0) m_buffer.append(',');
+		appendNumber(path.elementAt(i).y);
+	}
+	m_buffer.append("],\"types\":[");
+	for (int i = 0; i < count; i++) {
+		if (i > 0) m_buffer.append(',');
+		m_buffer.append(static_cast<char>('0' + static_cast<int>(path.elementAt(i).type)));
+	}
+	m_buffer.append(']');
+}
+
+void QvdJsonWriter::appendBase64Path(const QPainterPath& path) {
+	const int count = path.elementCount();
+
+	auto appendCoordinates = [&](const char* key, qreal QPainterPath::Element::* coordinate) {
+		m_scratch.resize(count * 8);
+		char* data = m_scratch.data();
+		for (int i = 0; i < count; i++) {
+			const double value = path.elementAt(i).*coordinate;
+			quint64 bits;
+			memcpy(&bits, &value, sizeof(bits));
+			qToLittleEndian(bits, data + i * 8);
+		}
+		m_buffer.append(key);
+		m_buffer.append(m_scratch.toBase64());
+		m_buffer.append('"');
+	};
+	appendCoordinates(",\"xs\":\"", &QPainterPath::Element::x);
+	appendCoordinates(",\"ys\":\"", &QPainterPath::Element::y);
+
+	m_scratch.resize(count);
+	for (int i = 0; i < count; i++) {
+		m_scratch[i] = static_cast<char>(path.elementAt(i).type);
+	}
+	m_buffer.append(",\"types\":\"");
+	m_buffer.append(m_scratch.toBase64());
+	m_buffer.append('"');
+}
+
+const QByteArray& QvdJsonWriter::styleFields(const StrokeItem& stroke) {
+	// Indices are per table, a scene's items normally all share one
+	if (m_styleTable != stroke.styleTable().get()) {
+		m_styleFields.clear();
+		m_styleTable = stroke.styleTable().get();
+	}
+
+	const StrokeStyleTable::Index index = stroke.styleIndex();
+	if (index >= static_cast<StrokeStyleTable::Index>(m_styleFields.size())) {
+		m_styleFields.resize(index + 1);
+	}
+
+	QByteArray& fields = m_styleFields[index];
+	if (fields.isEmpty()) {
+		const StrokeStyle& style = stroke.style();
+
+		// Formatted through m_buffer so numbers match the rest of the file
+		const qsizetype start = m_buffer.size();
+		m_buffer.append(style.outlined ? "{\"type\":\"filled\"" : "{\"type\":\"stroke\"");
+		m_buffer.append(",\"color\":\"");
+		m_buffer.append(style.color.name().toLatin1());
+		m_buffer.append("\",\"alpha\":");
+		m_buffer.append(QByteArray::number(style.color.alpha()));
+		m_buffer.append(",\"width\":");
+		appendNumber(style.width);
+		fields = m_buffer.mid(start);
+		m_buffer.truncate(start);
+	}
+	return fields;
+}
+
+void QvdJsonWriter::appendItem(const StrokeItem& stroke) {
+	// Same fields as the original format, only the path data differs
+	m_buffer.append(styleFields(stroke));
+	m_buffer.append(",\"posX\":");
+	appendNumber(stroke.pos().x());
+	m_buffer.append(",\"posY\":");
+	appendNumber(stroke.pos().y());
+
+	const QPainterPath path = stroke.geometry();
+	if (m_encoding == QvdPathEncoding::Base64) {
+		appendBase64Path(path);
+	}
+	else {
+		appendPackedPath(path);
+	}
+	m_buffer.append('}');
+}
+
+bool QvdJsonWriter::flush(bool force) {
+	if (!force && m_buffer.size() < FLUSH_THRESHOLD) return true;
+
+	if (m_file.write(m_buffer) != m_buffer.size()) {
+		m_error = "Unable to write " + m_file.fileName() + ": " + m_file.errorString();
+		return false;
+	}
+	m_buffer.truncate(0); // Keeps the capacity for the next chunk
+	return true;
+}
+
+bool QvdJsonWriter::write(const QString& fileName, const QGraphicsScene& scene) {
+	m_error.clear();
+	m_buffer.truncate(0);
+	m_styleTable = nullptr; // The previous scene's table may be gone by now
+
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::WriteOnly)) {
+		m_error = "Unable to open file for writing: " + m_file.errorString();
+		return false;
+	}
+
+	m_buffer.append("{\"version\":");
+	m_buffer.append(QByteArray::number(FILE_FORMAT_VERSION));
+	m_buffer.append(m_encoding == QvdPathEncoding::Base64 ? ",\"encoding\":\"base64\"" : ",\"encoding\":\"packed\"");
+	m_buffer.append(",\"items\":[\n");
+
+	bool ok = true;
+	bool first = true;
+	for (QGraphicsItem* item : scene.items()) {
+		const StrokeItem* stroke = dynamic_cast<const StrokeItem*>(item);
+		// Onion skin copies are children of a group and aren't part of the drawing
+		if (!stroke || item->parentItem()) continue;
+
+		if (!first) m_buffer.append(",\n");
+		first = false;
+		appendItem(*stroke);
+
+		if (!flush()) {
+			ok = false;
+			break;
+		}
+	}
+
+	if (ok) {
+		m_buffer.append("\n]}\n");
+		ok = flush(true);
+	}
+
+	if (!ok) {
+		// Throws the temporary file away, the existing file stays untouched
+		m_file.cancelWriting();
+		m_file.commit();
+	}
+	else if (!m_file.commit()) {
+		m_error = "Unable to write " + fileName + ": " + m_file.errorString();
+		ok = false;
+	}
+	m_buffer.truncate(0);
+	return ok;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <QtWidgets>
+#include "StrokeItem.h"
+
+// How the points of a path are stored in a .qvd file
+enum class QvdPathEncoding {
+	Packed,  // "xs", "ys" and "types" as plain JSON arrays
+	Base64   // The same arrays as base64 blobs of little-endian doubles and bytes
+};
+
+// Writes .qvd files without building a QJsonDocument. The JSON text is
+// assembled in a buffer that is flushed to the file as it fills up, so it
+// stays small however large the drawing is.
+class QvdJsonWriter {
+public:
+	explicit QvdJsonWriter(QvdPathEncoding encoding = QvdPathEncoding::Packed);
+
+	void setEncoding(QvdPathEncoding encoding) { m_encoding = encoding; }
+	QvdPathEncoding encoding() const { return m_encoding; }
+
+	bool write(const QString& fileName, const QGraphicsScene& scene);
+	QString errorString() const { return m_error; }
+
+private:
+	void appendItem(const StrokeItem& stroke);
+	const QByteArray& styleFields(const StrokeItem& stroke);
+	void appendNumber(double value);
+	void appendPackedPath(const QPainterPath& path);
+	void appendBase64Path(const QPainterPath& path);
+	bool flush(bool force = false);
+
+	QSaveFile m_file; // The previous file is only replaced once everything is written
+	QByteArray m_buffer;
+	QByteArray m_scratch; // Raw bytes of base64 encoded arrays
+	QList<QByteArray> m_styleFields; // Type, color and width text per style index, styles never change
+	const StrokeStyleTable* m_styleTable = nullptr; // The table m_styleFields is for
+	QvdPathEncoding m_encoding;
+	QString m_error;
+};
\ No newline at end of file
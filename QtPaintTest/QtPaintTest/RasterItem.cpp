@@ -1,36 +1,34 @@
 #include "RasterItem.h"
 
-RasterItem::RasterItem(const QImage& image) : BaseItem(), m_image(image) {
-    // Create a rectangle path with the image's aspect ratio
-    if (!m_image.isNull()) {
-        QPainterPath path;
-        QRectF rect(0, 0, m_image.width(), m_image.height());
-        path.addRect(rect);
-        setPath(path);
-    }
+RasterItem::RasterItem(QImage image) : RasterItem(image, image.size()) {
 }
 
-RasterItem::RasterItem(const QString& imagePath) : BaseItem() {
-    // Load image from path
-    m_image.load(imagePath);
+RasterItem::RasterItem(QImage image, const QSizeF& size)
+    : BaseItem(), m_tiles(std::make_shared<RasterTileStore>(std::move(image))) {
+    // Paint only draws the tiles in the exposed rect, which needs to be the real one
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+
     // Create a rectangle path with the image's aspect ratio
-    if (!m_image.isNull()) {
+    if (!size.isEmpty()) {
         QPainterPath path;
-        QRectF rect(0, 0, m_image.width(), m_image.height());
+        QRectF rect(QPointF(0, 0), size);
         path.addRect(rect);
         setPath(path);
     }
 }
 
-RasterItem::RasterItem(const RasterItem& other) : BaseItem(), m_image(other.m_image) {
-    // Copy the path from the other item
+RasterItem::RasterItem(const QString& imagePath) : RasterItem(QImage(imagePath)) {
+}
+
+RasterItem::RasterItem(const RasterItem& other) : BaseItem(), m_tiles(other.m_tiles) {
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+
+    // The path and the image are shared, only what differs from a fresh item is set
     setPath(other.path());
-    setPos(other.pos());
-    setRotation(other.rotation());
-    setScale(other.scale());
-    setTransform(other.transform());
-    setZValue(other.zValue());
-    setSelected(other.isSelected());
+    if (!other.transform().isIdentity()) setTransform(other.transform());
+    if (!other.pos().isNull()) setPos(other.pos());
+    if (other.zValue() != 0) setZValue(other.zValue());
+    if (other.isSelected()) setSelected(true);
 }
 
 BaseItem* RasterItem::clone() const {
@@ -41,11 +39,9 @@ BaseItem* RasterItem::clone() const {
 void RasterItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
     Q_UNUSED(widget);
 
-    // Draw the image filling the path's bounding rect
-    if (!m_image.isNull()) {
-        painter->setRenderHint(QPainter::SmoothPixmapTransform);
-        painter->drawImage(boundingRect(), m_image);
-    }
+    // Draw the visible part of the image filling the path's bounding rect
+    const qreal levelOfDetail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    m_tiles->draw(painter, path().boundingRect(), option->exposedRect, levelOfDetail, scene());
 
     // Show selection outline if selected
     if (m_isSelected) {
@@ -1,10 +1,14 @@
 #pragma once
 #include <QtWidgets>
+#include <memory>
 #include "BaseItem.h"
+#include "RasterTileStore.h"
 
 class RasterItem : public BaseItem {
 public:
-    RasterItem(const QImage& image);
+    RasterItem(QImage image);
+    // The image is stretched over size, used for placeholders of images that are still loading
+    RasterItem(QImage image, const QSizeF& size);
     RasterItem(const QString& imagePath);
     RasterItem(const RasterItem& other);
     ~RasterItem() = default;
@@ -12,9 +16,14 @@ public:
     // BaseItem interface implementation
     BaseItem* clone() const override;
 
+    const QImage& image() const { return m_tiles->image(); }
+    const std::shared_ptr<RasterTileStore>& tiles() const { return m_tiles; }
+    bool isLoading() const { return m_tiles->isLoading(); }
+
     // QGraphicsItem interface override
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
 
 private:
-    QImage m_image;
+    // Shared with every clone of the item
+    std::shared_ptr<RasterTileStore> m_tiles;
 };
\ No newline at end of file
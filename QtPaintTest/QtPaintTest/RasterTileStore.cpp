@@ -0,0 +1,110 @@
+#include "RasterTileStore.h"
+#include <cmath>
+
+RasterTileStore::RasterTileStore(QImage image) {
+	replaceImage(std::move(image));
+}
+
+void RasterTileStore::replaceImage(QImage image) {
+	// Painting converts anything else to a premultiplied format on every call,
+	// doing it once here keeps that temporary copy out of each paint
+	if (!image.isNull()) {
+		image.convertTo(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+	}
+
+	int levelCount = 1;
+	while (qMax(levelSize(image.size(), levelCount - 1).width(), levelSize(image.size(), levelCount - 1).height()) > TILE_SIZE) {
+		levelCount++;
+	}
+
+	QMutexLocker locker(&m_mutex);
+	m_image = std::move(image);
+	m_levelCount = levelCount;
+	m_levels.clear();
+	m_generation++;
+}
+
+QSize RasterTileStore::levelSize(const QSize& size, int level) {
+	return QSize(qMax(1, size.width() >> level), qMax(1, size.height() >> level));
+}
+
+QImage RasterTileStore::level(int level, QGraphicsScene* scene) {
+	if (level == 0) return m_image;
+
+	QMutexLocker locker(&m_mutex);
+	if (!m_levels.isEmpty()) return m_levels[level - 1];
+
+	// Not built yet, the full image stands in for it meanwhile
+	if (scene) m_waiting.append(scene);
+	if (!m_building) {
+		m_building = true;
+		QThreadPool::globalInstance()->start([self = shared_from_this(), source = m_image,
+			levelCount = m_levelCount, generation = m_generation]() {
+			self->buildLevels(source, levelCount, generation);
+		});
+	}
+	return m_image;
+}
+
+void RasterTileStore::buildLevels(QImage source, int levelCount, int generation) {
+	// Every level is filtered down from the one above it, not from the full image
+	QList<QImage> levels;
+	levels.reserve(levelCount - 1);
+	for (int level = 1; level < levelCount; level++) {
+		const QImage& above = level == 1 ? source : levels.last();
+		levels.append(above.scaled(levelSize(source.size(), level), Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+	}
+
+	QList<QPointer<QGraphicsScene>> waiting;
+	{
+		QMutexLocker locker(&m_mutex);
+		// If the image was replaced meanwhile the next paint asks again
+		if (generation == m_generation) {
+			m_levels = std::move(levels);
+		}
+		m_building = false;
+		waiting.swap(m_waiting);
+	}
+
+	// Built on a pool thread, the scenes are only touched back on the GUI thread
+	if (!qApp) return;
+	QMetaObject::invokeMethod(qApp, [waiting]() {
+		for (const QPointer<QGraphicsScene>& scene : waiting) {
+			if (scene) scene->update();
+		}
+	}, Qt::QueuedConnection);
+}
+
+void RasterTileStore::draw(QPainter* painter, const QRectF& target, const QRectF& exposed,
+	qreal levelOfDetail, QGraphicsScene* scene) {
+	if (m_image.isNull() || target.isEmpty()) return;
+
+	// Each level halves the resolution, levelOfDetail is device pixels per image pixel
+	int wanted = 0;
+	const qreal devicePixelsPerPixel = levelOfDetail > 0 ? target.width() / m_image.width() * levelOfDetail : 1.0;
+	if (devicePixelsPerPixel > 0 && devicePixelsPerPixel < 0.5) {
+		wanted = qMin(m_levelCount - 1, static_cast<int>(std::floor(std::log2(1.0 / devicePixelsPerPixel))));
+	}
+	const QImage image = level(wanted, scene);
+
+	// Visible area in the level's pixels, grown to whole tiles
+	const QRectF visible = exposed.intersected(target);
+	if (visible.isEmpty()) return;
+
+	const qreal scaleX = image.width() / target.width();
+	const qreal scaleY = image.height() / target.height();
+	const int left = static_cast<int>(std::floor((visible.left() - target.left()) * scaleX / TILE_SIZE)) * TILE_SIZE;
+	const int top = static_cast<int>(std::floor((visible.top() - target.top()) * scaleY / TILE_SIZE)) * TILE_SIZE;
+	const int right = qMin(image.width(), static_cast<int>(std::ceil((visible.right() - target.left()) * scaleX / TILE_SIZE)) * TILE_SIZE);
+	const int bottom = qMin(image.height(), static_cast<int>(std::ceil((visible.bottom() - target.top()) * scaleY / TILE_SIZE)) * TILE_SIZE);
+	if (right <= left || bottom <= top) return;
+
+	// The visible tiles are one block of the level, drawing them in one call
+	// keeps the filtering seamless across tile borders
+	const QRect source(qMax(0, left), qMax(0, top), right - qMax(0, left), bottom - qMax(0, top));
+	const QRectF destination(target.left() + source.left() / scaleX, target.top() + source.top() / scaleY,
+		source.width() / scaleX, source.height() / scaleY);
+
+	painter->setRenderHint(QPainter::SmoothPixmapTransform);
+	painter->drawImage(destination, image, source);
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+#include <QtWidgets>
+#include <memory>
+
+// Pixels of an imported image plus a pyramid of half size copies of it, so
+// zoomed out views don't have to filter the full image on every paint. The
+// smaller levels are built in the background the first time one is needed,
+// until then the full image is drawn. RasterItems share the store between
+// their clones.
+class RasterTileStore : public std::enable_shared_from_this<RasterTileStore> {
+public:
+	// Images are drawn in whole tiles of this size, the smallest level fits in one
+	static const int TILE_SIZE = 256;
+
+	explicit RasterTileStore(QImage image);
+
+	// The full resolution image. Only changes through replaceImage(), both are GUI thread only
+	const QImage& image() const { return m_image; }
+	int levelCount() const { return m_levelCount; }
+
+	// Swaps in another image for the same item, such as the decoded file for
+	// an import's placeholder. Levels of the old image are dropped.
+	void replaceImage(QImage image);
+
+	// Set while the importer is still decoding the file, image() is only a
+	// placeholder or a preview until then. GUI thread only.
+	bool isLoading() const { return m_loading; }
+	void setLoading(bool loading) { m_loading = loading; }
+
+	// Draws the tiles of the image that intersect exposed, at the coarsest level
+	// that still has a pixel for every device pixel. target is where the whole
+	// image goes, scene is repainted once the level it wanted is built.
+	void draw(QPainter* painter, const QRectF& target, const QRectF& exposed,
+		qreal levelOfDetail, QGraphicsScene* scene);
+
+private:
+	static QSize levelSize(const QSize& size, int level);
+	QImage level(int level, QGraphicsScene* scene);
+	void buildLevels(QImage source, int levelCount, int generation);
+
+	QImage m_image;
+	int m_levelCount = 1;
+	bool m_loading = false;
+
+	QMutex m_mutex;
+	QList<QImage> m_levels; // Everything from level 1 down, empty until built
+	bool m_building = false;
+	int m_generation = 0;   // Bumped by replaceImage(), levels of an older image are thrown away
+	QList<QPointer<QGraphicsScene>> m_waiting;
+};
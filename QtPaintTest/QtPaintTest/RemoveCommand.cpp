@@ -3,17 +3,18 @@
 // RemoveCommand Implementation
 RemoveCommand::RemoveCommand(DrawingScene* scene, BaseItem* item, QUndoCommand* parent) : QUndoCommand(parent), myScene(scene), myItem(item)
 {
+    if (myItem) myItem->retainHistory();
     setText(QString("Remove Shape %1").arg(QString::number(reinterpret_cast<uintptr_t>(item), 16)));
 }
 
 RemoveCommand::~RemoveCommand() {
-    // QUndoStack manages command deletion. We assume the item's lifetime
-    // is managed elsewhere (e.g., by the scene or another command like EraseCommand)
-    // unless explicitly handled (like in AddCommand's destructor).
+    // A removed item is deleted with the last command that refers to it
+    if (myItem) myItem->releaseHistory();
 }
 
 void RemoveCommand::undo() {
     if (myScene && myItem) {
+        myItem->rehydrate();
         myScene->addItem(myItem);
         myItem->update();
     }
@@ -22,5 +23,6 @@ void RemoveCommand::undo() {
 void RemoveCommand::redo() {
     if (myScene && myItem) {
         myScene->removeItem(myItem);
+        myItem->dehydrate();
     }
 }
\ No newline at end of file
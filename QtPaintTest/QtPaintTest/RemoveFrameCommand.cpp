@@ -0,0 +1,23 @@
+#include "RemoveFrameCommand.h"
+#include "MainWindow.h"
+
+// RemoveFrameCommand Implementation
+RemoveFrameCommand::RemoveFrameCommand(MainWindow* window, int index, QUndoCommand* parent)
+    : QUndoCommand(parent), myWindow(window), myIndex(index), myFrame(nullptr)
+{
+    setText(QString("Remove Frame %1").arg(index + 1));
+}
+
+RemoveFrameCommand::~RemoveFrameCommand() {
+    // Only set while the frame is out of the project
+    delete myFrame;
+}
+
+void RemoveFrameCommand::undo() {
+    myWindow->insertFrame(myIndex, myFrame);
+    myFrame = nullptr;
+}
+
+void RemoveFrameCommand::redo() {
+    myFrame = myWindow->takeFrame(myIndex);
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+#include <QtWidgets>
+#include "DrawingScene.h"
+
+class MainWindow;
+
+// Project level command, takes a frame out of the timeline and keeps it, with its history, for undo
+class RemoveFrameCommand : public QUndoCommand {
+public:
+    RemoveFrameCommand(MainWindow* window, int index, QUndoCommand* parent = nullptr);
+    ~RemoveFrameCommand();
+    void undo() override;
+    void redo() override;
+private:
+    MainWindow* myWindow;
+    int myIndex;
+    DrawingScene* myFrame;
+};
\ No newline at end of file
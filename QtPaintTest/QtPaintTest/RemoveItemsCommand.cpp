@@ -0,0 +1,32 @@
+#include "RemoveItemsCommand.h"
+
+// RemoveItemsCommand Implementation
+RemoveItemsCommand::RemoveItemsCommand(DrawingScene* scene, const QList<BaseItem*>& items, QUndoCommand* parent)
+    : QUndoCommand(parent), myScene(scene), myItems(items)
+{
+    for (BaseItem* item : myItems) item->retainHistory();
+    setText(QString("Remove %1 Shapes").arg(items.size()));
+}
+
+RemoveItemsCommand::~RemoveItemsCommand() {
+    // Removed items are deleted with the last command that refers to them
+    for (BaseItem* item : myItems) item->releaseHistory();
+}
+
+void RemoveItemsCommand::undo() {
+    if (!myScene) return;
+
+    for (BaseItem* item : myItems) {
+        item->rehydrate();
+    }
+    myScene->addItems(myItems);
+}
+
+void RemoveItemsCommand::redo() {
+    if (!myScene) return;
+
+    myScene->removeItems(myItems);
+    for (BaseItem* item : myItems) {
+        item->dehydrate();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+#include <QtWidgets>
+#include "DrawingScene.h"
+#include "BaseItem.h"
+
+// Removes a batch of items as a single undo step
+class RemoveItemsCommand : public QUndoCommand {
+public:
+    RemoveItemsCommand(DrawingScene* scene, const QList<BaseItem*>& items, QUndoCommand* parent = nullptr);
+    ~RemoveItemsCommand();
+    void undo() override;
+    void redo() override;
+private:
+    DrawingScene* myScene;
+    QList<BaseItem*> myItems;
+};
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "ScratchArena.h"
+
+namespace {
+	const size_t INITIAL_BLOCK_SIZE = 256 * 1024;
+	const size_t MAX_RETAINED_BLOCK_SIZE = 32 * 1024 * 1024; // Larger blocks are given back to the heap
+}
+
+ScratchArena::Block& ScratchArena::threadBlock() {
+	static thread_local Block block;
+	return block;
+}
+
+ScratchArena::ScratchArena() {
+	Block& block = threadBlock();
+	if (block.inUse) {
+		// The outer arena owns the block, this one starts from the heap
+		m_resource.emplace(&m_upstream);
+		return;
+	}
+
+	if (!block.data) {
+		block.data = std::make_unique<std::byte[]>(INITIAL_BLOCK_SIZE);
+		block.size = INITIAL_BLOCK_SIZE;
+	}
+	block.inUse = true;
+	m_block = &block;
+	m_resource.emplace(block.data.get(), block.size, &m_upstream);
+}
+
+ScratchArena::~ScratchArena() {
+	m_resource.reset(); // Returns everything taken from the heap
+
+	if (!m_block) return;
+	m_block->inUse = false;
+
+	// Grow the retained block so the next operation of this size fits in it
+	if (m_upstream.allocated > 0 && m_block->size < MAX_RETAINED_BLOCK_SIZE) {
+		size_t size = m_block->size;
+		while (size < m_block->size + m_upstream.allocated && size < MAX_RETAINED_BLOCK_SIZE) {
+			size *= 2;
+		}
+		m_block->data = std::make_unique<std::byte[]>(size);
+		m_block->size = size;
+	}
+}
+
+void* ScratchArena::Upstream::do_allocate(size_t bytes, size_t alignment) {
+	allocated += bytes;
+	return ::operator new(bytes, std::align_val_t(alignment));
+}
+
+void ScratchArena::Upstream::do_deallocate(void* p, size_t bytes, size_t alignment) {
+	::operator delete(p, bytes, std::align_val_t(alignment));
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+#include <QtWidgets>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+// Scratch memory for one operation, such as a fill or an erase. Allocations
+// only bump a pointer and everything is released at once when the arena goes
+// out of scope. Every thread keeps its first block between operations, grown
+// to what earlier operations needed, so a typical operation doesn't touch the
+// heap at all.
+class ScratchArena {
+public:
+	ScratchArena();
+	~ScratchArena();
+	ScratchArena(const ScratchArena&) = delete;
+	ScratchArena& operator=(const ScratchArena&) = delete;
+
+	std::pmr::memory_resource* resource() { return &*m_resource; }
+
+	template<typename T>
+	std::pmr::vector<T> vector(size_t reserve = 0) {
+		std::pmr::vector<T> result(resource());
+		result.reserve(reserve);
+		return result;
+	}
+
+private:
+	// Forwards to the heap and counts what the arena needed beyond its block
+	class Upstream : public std::pmr::memory_resource {
+	public:
+		size_t allocated = 0;
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+	};
+
+	struct Block {
+		std::unique_ptr<std::byte[]> data;
+		size_t size = 0;
+		bool inUse = false;
+	};
+	static Block& threadBlock();
+
+	Block* m_block = nullptr; // Null for an arena nested in another one on the same thread
+	Upstream m_upstream;
+	std::optional<std::pmr::monotonic_buffer_resource> m_resource;
+};
\ No newline at end of file
@@ -2,7 +2,7 @@
 #include "DrawingScene.h"
 #include "DrawingManager.h"
 #include "MoveCommand.h"
-#include "RemoveCommand.h"
+#include "RemoveItemsCommand.h"
 
 SelectTool::SelectTool() {
     // Initialize key tracking
@@ -151,8 +151,8 @@ void SelectTool::keyPressEvent(QKeyEvent* event) {
                 DrawingManager::getInstance().getScene()->removeItem(item);
                 delete item;
             }*/
-            for (BaseItem* item : itemsToRemove) {
-                RemoveCommand* cmd = new RemoveCommand(DrawingManager::getInstance().getScene(), item);
+            if (!itemsToRemove.isEmpty()) {
+                RemoveItemsCommand* cmd = new RemoveItemsCommand(DrawingManager::getInstance().getScene(), itemsToRemove);
                 DrawingManager::getInstance().pushCommand(cmd);
             }
             // Clean up selection UI elements
@@ -521,7 +521,7 @@ void SelectTool::createSelectionBox() {
     // Calculate bounds of all selected items
     QRectF bounds;
     for (auto item : m_selectedItems) {
-        QPainterPath path = item->path();
+        QPainterPath path = item->geometry();
         QTransform t = item->transform();
         QPainterPath mappedPath = t.map(path);
         mappedPath.translate(item->pos());
@@ -661,7 +661,7 @@ void SelectTool::startTransform(const QPointF& pos, TransformHandleType handleTy
         m_transform.itemStates[item] = {
             item->pos(),
             item->transform(),
-            item->path()
+            item->geometry()
         };
     }
 
@@ -867,7 +867,7 @@ void SelectTool::applyTransformToItems() {
         QPainterPath newPath = currentTransform.map(m_transform.itemStates[item].originalPath);
         newPath.translate(currentPos);
 
-        item->setPath(newPath);
+        item->setGeometry(newPath);
         item->setPos(0, 0);
         item->setTransform(QTransform());
     }
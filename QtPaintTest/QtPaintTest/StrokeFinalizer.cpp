@@ -0,0 +1,69 @@
+#include "StrokeFinalizer.h"
+#include "AddCommand.h"
+#include "DrawingManager.h"
+#include "PerfMonitor.h"
+
+void StrokeFinalizer::submit(StrokeItem* item, DrawingScene* scene, OutlineTask task) {
+	std::shared_ptr<Job> job = std::make_shared<Job>();
+	job->item = item;
+	job->scene = scene;
+	job->task = std::move(task);
+	m_jobs.push_back(job);
+
+	QThreadPool::globalInstance()->start([job]() {
+		if (!run(*job) || !qApp) return;
+
+		QMetaObject::invokeMethod(qApp, []() {
+			StrokeFinalizer::getInstance().applyFinished();
+		}, Qt::QueuedConnection);
+	});
+}
+
+void StrokeFinalizer::finishPending() {
+	if (m_jobs.empty()) return;
+	PerfScope scope("stroke/finishPending");
+
+	for (const std::shared_ptr<Job>& job : m_jobs) {
+		if (!run(*job)) {
+			job->done.acquire(); // A worker has it, wait until it's through
+		}
+	}
+	applyFinished();
+}
+
+bool StrokeFinalizer::run(Job& job) {
+	int expected = Queued;
+	if (!job.state.compare_exchange_strong(expected, Running)) return false;
+
+	{
+		PerfScope scope("stroke/finalize");
+		job.outline = job.task();
+	}
+	job.task = nullptr; // Drops the captured geometry on the thread that used it
+	job.state.store(Done, std::memory_order_release);
+	job.done.release();
+	return true;
+}
+
+void StrokeFinalizer::applyFinished() {
+	while (!m_jobs.empty() && m_jobs.front()->state.load(std::memory_order_acquire) == Done) {
+		const std::shared_ptr<Job> job = std::move(m_jobs.front());
+		m_jobs.pop_front();
+
+		// The frame went away and took the item with it
+		DrawingScene* scene = job->scene;
+		if (!scene) continue;
+
+		// Nothing is painted between the swap and the push, the raw stroke is
+		// replaced by its outline in one step
+		job->item->setFilledOutline(job->outline);
+		scene->removeItem(job->item);
+		AddCommand* command = new AddCommand(scene, job->item);
+		if (scene == DrawingManager::getInstance().getScene()) {
+			DrawingManager::getInstance().pushCommand(command);
+		}
+		else {
+			scene->undoStack()->push(command);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include <QtWidgets>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <clipper2/clipper.h>
+#include "DrawingScene.h"
+
+// Finishes brush strokes on the global thread pool. A stroke stays on screen
+// as it was drawn while its outline is computed, then the outline is swapped
+// into the item and the item's AddCommand pushed in one go on the GUI thread.
+// Strokes are applied in the order they were submitted.
+class StrokeFinalizer {
+private:
+	StrokeFinalizer() = default;
+	StrokeFinalizer(const StrokeFinalizer&) = delete;
+	StrokeFinalizer& operator=(const StrokeFinalizer&) = delete;
+public:
+	static StrokeFinalizer& getInstance() {
+		static StrokeFinalizer instance;
+		return instance;
+	}
+
+	// Runs on a worker with only the data it captured, returns the filled
+	// outline in item coordinates scaled by CLIPPER_SCALING
+	using OutlineTask = std::function<Clipper2Lib::Paths64()>;
+
+	// item has to be in scene, it's taken over until the outline is applied
+	void submit(StrokeItem* item, DrawingScene* scene, OutlineTask task);
+
+	// Applies every submitted stroke before returning, running the ones no
+	// worker has picked up yet on this thread. Whatever reads or edits the
+	// strokes of a scene, like the eraser or undo, calls this first.
+	void finishPending();
+	bool hasPending() const { return !m_jobs.empty(); }
+
+private:
+	enum State { Queued, Running, Done };
+	struct Job {
+		StrokeItem* item = nullptr;
+		QPointer<DrawingScene> scene;
+		OutlineTask task;
+		Clipper2Lib::Paths64 outline;
+		std::atomic<int> state{ Queued };
+		QSemaphore done;
+	};
+
+	// Computes the outline unless another thread already took the job
+	static bool run(Job& job);
+	// Applies the finished jobs at the front of the queue
+	void applyFinished();
+
+	std::deque<std::shared_ptr<Job>> m_jobs; // GUI thread only
+};
\ No newline at end of file
@@ -1,72 +1,258 @@
 #include "StrokeItem.h"
+#include "PerfMonitor.h"
 
-StrokeItem::StrokeItem(const QColor& color, qreal width)
-    : m_color(color), m_width(width), m_isOutlined(false)
+StrokeItem::StrokeItem(const QColor& color, qreal width, const std::shared_ptr<StrokeStyleTable>& styles)
+    : m_styles(styles),
+    m_style(styles->intern(color, width, false))
 {
-    QPen pen(m_color, m_width);
-    pen.setCapStyle(Qt::RoundCap);
-    pen.setJoinStyle(Qt::RoundJoin);
-    setPen(pen);
-	if (width > 0) {
-		setBrush(Qt::NoBrush); // No fill for stroke
-	}
-	else {
-		setBrush(QBrush(m_color)); // Fill with color if width is 0
-	}
+    setStyle(m_style);
 }
 
-StrokeItem::StrokeItem(const QColor& fillColor)
-    : m_color(fillColor), m_width(0), m_isOutlined(true)  // Note: isOutlined=true for filled shapes
+StrokeItem::StrokeItem(const QColor& fillColor, const std::shared_ptr<StrokeStyleTable>& styles)
+    : m_styles(styles),
+    m_style(styles->intern(fillColor, 0, true))  // Note: isOutlined=true for filled shapes
 {
-    // Set up a proper filled shape
-    setBrush(QBrush(fillColor));
+    setStyle(m_style);
+}
 
-    // Thin outline for better definition
-    QPen outlinePen(fillColor.darker(120), 0.5);
-    outlinePen.setJoinStyle(Qt::RoundJoin);
-    setPen(outlinePen);
+StrokeItem::StrokeItem(StrokeRecord record)
+	: m_styles(record.styles ? record.styles : StrokeStyleTable::forScene(nullptr)),
+	m_style(record.styles ? record.style : 0),
+	m_compactPath(std::move(record.compactPath)),
+	m_storedPath(std::move(record.storedPath))
+{
+	const StrokeStyle& resolved = style();
+	setPen(resolved.pen);
+	setBrush(resolved.brush);
+
+	// Only what differs from a fresh item is set
+	if (!record.path.isEmpty()) QGraphicsPathItem::setPath(record.path);
+	if (!record.transform.isIdentity()) setTransform(record.transform);
+	if (!record.pos.isNull()) setPos(record.pos);
 }
 
-StrokeItem::StrokeItem(const StrokeItem& other)
-	: m_color(other.m_color), m_width(other.m_width),
-	m_isOutlined(other.m_isOutlined),
-	m_originalPen(other.m_originalPen)
+StrokeItem::StrokeItem(const StrokeItem& other) : StrokeItem(other.record())
 {
-	setPen(m_originalPen);
-	setBrush(brush());
+	if (other.m_isSelected) {
+		setSelected(true);
+	}
+}
+
+StrokeRecord StrokeItem::record() const {
+	StrokeRecord record;
+	record.compactPath = m_compactPath;
+	record.path = QGraphicsPathItem::path();
+	record.storedPath = m_storedPath;
+	record.styles = m_styles;
+	record.style = m_style;
+	if (m_widthOutline) {
+		// Still being drawn, the copy gets the outline as it is so far
+		const Clipper2Lib::Paths64 outline = m_widthOutline->outline();
+		const StrokeStyle& current = style();
+		record.style = m_styles->intern(current.color, current.width, true);
+		record.compactPath = CompactPath::fromClipper(outline);
+		if (record.compactPath.isNull()) {
+			record.path = QPainterPath();
+			DrawingEngineUtils::appendClipperPaths(outline, record.path);
+		}
+	}
+	record.transform = transform();
+	record.pos = pos();
+	return record;
+}
+
+QRectF StrokeRecord::sceneBoundingRect() const {
+	const QRectF bounds = compactPath.isNull() ? path.boundingRect() : compactPath.boundingRect();
+	return (transform * QTransform::fromTranslate(pos.x(), pos.y())).mapRect(bounds);
+}
 
-	// Copy the path
-	setPath(other.path());
+void StrokeItem::setStyle(StrokeStyleTable::Index style) {
+    m_style = style;
 
-	// Copy the transform
-	setTransform(other.transform());
-	setPos(other.pos());
-	setRotation(other.rotation());
-	setScale(other.scale());
+    // The pen and brush are implicitly shared with the table, the item keeps
+    // them only so QGraphicsPathItem computes the right bounds
+    const StrokeStyle& resolved = this->style();
+    setPen(m_isSelected ? resolved.highlightPen : resolved.pen);
+    setBrush(resolved.brush);
+    m_shape = QPainterPath();
 }
 
 void StrokeItem::setOutlined(bool outlined) {
-    m_isOutlined = outlined;
+    const StrokeStyle& current = style();
+    if (current.outlined == outlined) return;
+
+    setStyle(m_styles->intern(current.color, current.width, outlined));
+
+    // Outlined strokes switch to the compact storage and back
+    setGeometry(geometry());
+}
+
+QPainterPath StrokeItem::geometry() const {
+    return isCompact() ? m_compactPath.toPath() : QGraphicsPathItem::path();
+}
+
+void StrokeItem::setGeometry(const QPainterPath& path) {
+    // Only outlines are polygons, anything with curves stays a QPainterPath
+    if (isOutlined()) {
+        const CompactPath compact = CompactPath::fromPath(path);
+        if (!compact.isNull()) {
+            setCompactPath(compact);
+            return;
+        }
+    }
+
+    if (isCompact()) {
+        prepareGeometryChange();
+        m_compactPath = CompactPath();
+        m_shape = QPainterPath();
+    }
+    QGraphicsPathItem::setPath(path);
+}
+
+void StrokeItem::setCompactPath(const CompactPath& path) {
+    prepareGeometryChange();
+    m_compactPath = path;
+    m_shape = QPainterPath();
+    QGraphicsPathItem::setPath(QPainterPath());
+    update();
+}
+
+void StrokeItem::setClipperPaths(const Clipper2Lib::Paths64& paths) {
+    const CompactPath compact = CompactPath::fromClipper(paths);
+    if (!compact.isNull()) {
+        setCompactPath(compact);
+        return;
+    }
+
+    // Too large to quantize, or empty
+    QPainterPath path;
+    DrawingEngineUtils::appendClipperPaths(paths, path);
+    setGeometry(path);
+}
+
+Qt::FillRule StrokeItem::fillRule() const {
+    return isCompact() ? m_compactPath.fillRule() : QGraphicsPathItem::path().fillRule();
+}
+
+Clipper2Lib::Paths64 StrokeItem::clipperPaths() const {
+    Clipper2Lib::Paths64 paths;
+    clipperPaths(paths);
+    return paths;
+}
+
+void StrokeItem::clipperPaths(Clipper2Lib::Paths64& paths) const {
+    const QTransform toScene = sceneTransform();
+    if (isCompact() && toScene.type() <= QTransform::TxTranslate) {
+        m_compactPath.toClipper(paths, qRound64(toScene.dx() * CLIPPER_SCALING), qRound64(toScene.dy() * CLIPPER_SCALING));
+        return;
+    }
+
+    // Curves or a real transform, flattened through QPainterPath
+    const QList<QPolygonF> polygons = toScene.map(geometry()).toSubpathPolygons();
+    paths.resize(polygons.size());
+    for (qsizetype i = 0; i < polygons.size(); i++) {
+        DrawingEngineUtils::convertPolygonToClipper(polygons[i], paths[i]);
+    }
+}
+
+void StrokeItem::outlinePaths(Clipper2Lib::Paths64& paths) const {
+    if (isOutlined()) {
+        clipperPaths(paths);
+        return;
+    }
+    if (m_widthOutline) {
+        paths = m_widthOutline->outline();
+        const QTransform toScene = sceneTransform();
+        if (toScene.isIdentity()) return;
+
+        QPainterPath outline;
+        DrawingEngineUtils::appendClipperPaths(paths, outline);
+        const QList<QPolygonF> polygons = toScene.map(outline).toSubpathPolygons();
+        paths.resize(polygons.size());
+        for (qsizetype i = 0; i < polygons.size(); i++) {
+            DrawingEngineUtils::convertPolygonToClipper(polygons[i], paths[i]);
+        }
+        return;
+    }
+
+    // The same outline convertToFilledPath() would give the item
+    QPainterPathStroker stroker;
+    stroker.setCapStyle(Qt::RoundCap);
+    stroker.setJoinStyle(Qt::RoundJoin);
+    stroker.setWidth(width());
+
+    const QList<QPolygonF> polygons = sceneTransform().map(stroker.createStroke(geometry())).toSubpathPolygons();
+    paths.resize(polygons.size());
+    for (qsizetype i = 0; i < polygons.size(); i++) {
+        DrawingEngineUtils::convertPolygonToClipper(polygons[i], paths[i]);
+    }
+}
+
+void StrokeItem::addWidthSample(const QPointF& pos, qreal width) {
+    if (!m_widthOutline) {
+        m_widthOutline = std::make_unique<VariableWidthOutline>();
+    }
+    prepareGeometryChange();
+    m_widthOutline->addSample(pos, width);
+    update();
+}
+
+QRectF StrokeItem::boundingRect() const {
+    if (m_widthOutline) return m_widthOutline->boundingRect();
+    if (!isCompact()) return BaseItem::boundingRect();
+
+    // Same margin QGraphicsPathItem leaves for the pen
+    const qreal margin = pen().style() == Qt::NoPen ? 0 : pen().widthF() / 2;
+    return m_compactPath.boundingRect().adjusted(-margin, -margin, margin, margin);
+}
+
+QPainterPath StrokeItem::shape() const {
+    if (m_widthOutline) return m_widthOutline->preview();
+    if (!isCompact()) return BaseItem::shape();
+
+    // Hit tests and the scene index ask for it often, it's built once per
+    // geometry and pen
+    if (m_shape.isEmpty()) {
+        m_shape = m_compactPath.toPath();
+        if (pen().style() != Qt::NoPen && pen().widthF() > 0) {
+            QPainterPathStroker stroker(pen());
+            QPainterPath outline = m_shape;
+            m_shape = stroker.createStroke(outline);
+            m_shape.addPath(outline);
+        }
+    }
+    return m_shape;
 }
 
 void StrokeItem::convertToFilledPath() {
-    if (m_isOutlined) return;
+    if (isOutlined()) return;
+    PerfScope scope("stroke/convertToFilledPath");
+
+    setFilledOutline(outlineTask()());
+}
 
+std::function<Clipper2Lib::Paths64()> StrokeItem::outlineTask() const {
+    if (m_widthOutline) {
+        // Most of the union was done while the stroke was drawn
+        return [outline = *m_widthOutline]() { return outline.outline(); };
+    }
+    return [path = geometry(), width = width()]() { return filledOutline(path, width); };
+}
+
+Clipper2Lib::Paths64 StrokeItem::filledOutline(const QPainterPath& path, qreal width) {
     // Create a stroker to convert the path to an outline
     QPainterPathStroker stroker;
     stroker.setCapStyle(Qt::RoundCap);
     stroker.setJoinStyle(Qt::RoundJoin);
-    stroker.setWidth(m_width);
+    stroker.setWidth(width);
 
     // Get the stroked outline path
-    QPainterPath outlinePath = stroker.createStroke(path());
-
-    // Convert to Clipper2 format
-    Clipper2Lib::Path64 clipperPath = DrawingEngineUtils::convertPathToClipper(outlinePath);
+    QPainterPath outlinePath = stroker.createStroke(path);
 
-    // Create a paths collection with our path
-    Clipper2Lib::Paths64 subj;
-    subj.push_back(clipperPath);
+    // Convert to Clipper2 format, into a collection kept per thread so its
+    // capacity carries over from one stroke to the next
+    static thread_local Clipper2Lib::Paths64 subj(1);
+    DrawingEngineUtils::convertPathToClipper(outlinePath, subj[0]);
 
     // Use Clipper2 to simplify via union operation
     Clipper2Lib::Clipper64 clipper;
@@ -77,91 +263,102 @@ void StrokeItem::convertToFilledPath() {
     clipper.Execute(Clipper2Lib::ClipType::Union,
         Clipper2Lib::FillRule::NonZero,
         solution);
+    return solution;
+}
 
-    // If we got results, convert the paths back
-    if (!solution.empty()) {
-        QPainterPath simplifiedPath;
-
-        // Process each resulting path
-        for (const auto& resultPath : solution) {
-            QPainterPath subPath = DrawingEngineUtils::convertSingleClipperPath(resultPath);
-
-            // First path is the outline, subsequent paths are holes
-            if (simplifiedPath.isEmpty()) {
-                simplifiedPath = subPath;
-            }
-            else {
-                // Check orientation to determine if it's a hole
-                // Using area calculation to determine if inside or outside
-                if (Clipper2Lib::Area(resultPath) < 0) {
-                    simplifiedPath = simplifiedPath.subtracted(subPath);
-                }
-                else {
-                    simplifiedPath = simplifiedPath.united(subPath);
-                }
-            }
-        }
-
-        setPath(simplifiedPath);
+void StrokeItem::setFilledOutline(const Clipper2Lib::Paths64& outline) {
+    if (m_widthOutline) {
+        prepareGeometryChange();
+        m_widthOutline.reset();
     }
 
     // Update appearance - fill with color, thin outline
-    setBrush(QBrush(m_color));
-    setPen(QPen(m_color.darker(120), 0.5)); // Thin outline for definition
+    setOutlined(true);
 
-    m_isOutlined = true;
+    // The union already separates outlines from holes, so the result is kept
+    // as it comes out of Clipper without building a QPainterPath
+    if (!outline.empty()) {
+        setClipperPaths(outline);
+    }
 }
 
-QColor StrokeItem::color() const { return m_color; }
-qreal StrokeItem::width() const { return m_width; }
-bool StrokeItem::isOutlined() const { return m_isOutlined; }
+QColor StrokeItem::color() const { return style().color; }
+qreal StrokeItem::width() const { return style().width; }
+bool StrokeItem::isOutlined() const { return style().outlined; }
 
 StrokeItem* StrokeItem::clone() const {
-	StrokeItem* clone = new StrokeItem(m_color, m_width);
-	clone->setPath(path());
-	clone->setPen(pen());
-	clone->setBrush(brush());
-	clone->setOutlined(m_isOutlined);
+	return new StrokeItem(*this);
+}
+
+void StrokeItem::dehydrate() {
+	if (isDehydrated() || scene()) return;
 
-	// Copy selection state
-	clone->m_isSelected = m_isSelected;
-	clone->m_originalPen = m_originalPen;
+	// Compact strokes keep their quantized form, decoding them to a
+	// QPainterPath first would store several times the bytes
+	m_storedPath = isCompact() ? StoredPath(m_compactPath) : StoredPath(geometry());
+	setGeometry(QPainterPath());
+}
 
-	// Copy transform
-	clone->setTransform(transform());
-	clone->setPos(pos());
-	clone->setRotation(rotation());
-	clone->setScale(scale());
+void StrokeItem::rehydrate() {
+	if (!isDehydrated()) return;
 
-	return clone;
+	if (m_storedPath.isCompact()) {
+		setCompactPath(m_storedPath.compactPath());
+	}
+	else {
+		setGeometry(m_storedPath.path());
+	}
+	m_storedPath.reset();
 }
 
 void StrokeItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
-    // Draw the regular path first
-    QGraphicsPathItem::paint(painter, option, widget);
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    const StrokeStyle& resolved = style();
+    if (m_widthOutline) {
+        // The outline is filled, the pen's width doesn't apply
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(resolved.color);
+        painter->drawPath(m_widthOutline->preview());
+        return;
+    }
+
+    painter->setPen(m_isSelected ? resolved.highlightPen : resolved.pen);
+    painter->setBrush(resolved.brush);
+
+    if (isCompact()) {
+        // Decoded into a path that keeps its storage from one paint to the next
+        static thread_local QPainterPath scratch;
+        scratch.clear();
+        m_compactPath.appendTo(scratch);
+        painter->drawPath(scratch);
+    }
+    else {
+        painter->drawPath(QGraphicsPathItem::path());
+    }
+}
+
+QVariant StrokeItem::itemChange(GraphicsItemChange change, const QVariant& value) {
+    // Pasted, imported and duplicated items come with another table, the
+    // scene's document keeps its styles in its own
+    if (change == ItemSceneHasChanged && scene()) {
+        std::shared_ptr<StrokeStyleTable> styles = StrokeStyleTable::forScene(scene());
+        if (styles != m_styles) {
+            const StrokeStyleTable::Index index = styles->intern(style());
+            m_styles = std::move(styles);
+            setStyle(index);
+        }
+    }
+    return BaseItem::itemChange(change, value);
 }
 
 void StrokeItem::setSelected(bool selected) {
     if (selected == m_isSelected) return;
 
+    // Swaps between the style's pen and its highlight pen
     m_isSelected = selected;
-
-    if (selected) {
-        // Store original pen
-        m_originalPen = pen();
-
-        // Create highlight pen
-        QPen highlightPen = m_originalPen;
-        highlightPen.setColor(Qt::blue);
-        highlightPen.setWidth(m_originalPen.width() + 1);
-        highlightPen.setStyle(Qt::DashLine);
-
-        setPen(highlightPen);
-    }
-    else {
-        // Restore original pen
-        setPen(m_originalPen);
-    }
+    setStyle(m_style);
 
     update();
 }
\ No newline at end of file
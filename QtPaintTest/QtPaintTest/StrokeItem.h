@@ -3,28 +3,104 @@
 #include <clipper2/clipper.h>
 #include "DrawingEngineUtils.h"
 #include "BaseItem.h"
+#include "HistoryStore.h"
+#include "StrokeStyle.h"
+#include "CompactPath.h"
+#include "VariableWidthOutline.h"
+#include <functional>
+#include <memory>
 
+// Everything a StrokeItem is made of, without the QGraphicsItem around it.
+// All of it is implicitly shared, so records are cheap to copy and keep
+struct StrokeRecord {
+	CompactPath compactPath; // Outlines, used when not null
+	QPainterPath path;       // Geometry with curves
+	StoredPath storedPath;   // Geometry of a dehydrated item
+	std::shared_ptr<StrokeStyleTable> styles; // The table style refers to
+	StrokeStyleTable::Index style = 0;
+	QTransform transform;
+	QPointF pos;
+
+	// Bounds of the geometry once placed
+	QRectF sceneBoundingRect() const;
+};
 
 class StrokeItem : public BaseItem {
 public:
-	StrokeItem(const QColor& color, qreal width);
-	StrokeItem(const QColor& fillColor);
+	// The style is interned in styles, usually the target scene's table. Items
+	// move to the table of whichever scene they're added to.
+	StrokeItem(const QColor& color, qreal width, const std::shared_ptr<StrokeStyleTable>& styles);
+	StrokeItem(const QColor& fillColor, const std::shared_ptr<StrokeStyleTable>& styles);
+	// Sets everything up in one go, moving the record's data in
+	explicit StrokeItem(StrokeRecord record);
 	StrokeItem(const StrokeItem& other);
+
+	StrokeRecord record() const;
 	void setOutlined(bool outlined);
 	void convertToFilledPath();
+	// convertToFilledPath() in two halves, so the outline can be computed on
+	// another thread. The task only uses data it copied from the item.
+	std::function<Clipper2Lib::Paths64()> outlineTask() const;
+	void setFilledOutline(const Clipper2Lib::Paths64& outline);
+	// The round capped outline of path drawn width wide, in item coordinates
+	// scaled by CLIPPER_SCALING
+	static Clipper2Lib::Paths64 filledOutline(const QPainterPath& path, qreal width);
 	QColor color() const;
 	qreal width() const;
 	bool isOutlined() const;
 	void setSelected(bool selected) override;
 
+	// Outlined strokes are polygons and are kept as a CompactPath, geometry()
+	// builds a QPainterPath from it on demand
+	QPainterPath geometry() const override;
+	void setGeometry(const QPainterPath& path) override;
+	void setCompactPath(const CompactPath& path);
+	// Clipper output in item coordinates, each contour is closed
+	void setClipperPaths(const Clipper2Lib::Paths64& paths);
+	bool isCompact() const { return !m_compactPath.isNull(); }
+	Qt::FillRule fillRule() const;
+	// Geometry in scene coordinates scaled by CLIPPER_SCALING, compact paths
+	// that are only translated don't go through doubles at all
+	Clipper2Lib::Paths64 clipperPaths() const;
+	void clipperPaths(Clipper2Lib::Paths64& paths) const; // Reuses the vectors in paths
+	// Same as clipperPaths(), but for a stroke that isn't outlined yet it's the
+	// outline of what it paints. The item itself is left as it is.
+	void outlinePaths(Clipper2Lib::Paths64& paths) const;
+
+	// Strokes drawn with pressure or speed get their outline sample by sample
+	// and paint it instead of the pen. convertToFilledPath() takes it over as
+	// the item's geometry. Only strokes still being drawn have one, records
+	// and copies don't carry it.
+	void addWidthSample(const QPointF& pos, qreal width);
+	bool hasVariableWidth() const { return m_widthOutline != nullptr; }
+
+	QRectF boundingRect() const override;
+	QPainterPath shape() const override;
+
+	// Color, width and fill mode are shared through the StrokeStyleTable
+	const std::shared_ptr<StrokeStyleTable>& styleTable() const { return m_styles; }
+	StrokeStyleTable::Index styleIndex() const { return m_style; }
+	const StrokeStyle& style() const { return m_styles->style(m_style); }
+
+	// While the item is only referenced by the undo history its geometry
+	// lives in the HistoryStore, rehydrate() brings it back
+	void dehydrate() override;
+	void rehydrate() override;
+	bool isDehydrated() const { return !m_storedPath.isNull(); }
+
 	StrokeItem* clone() const override;
 
 protected:
 	void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+	QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
 
 private:
-	QColor m_color;
-	qreal m_width;
-	bool m_isOutlined;
-	QPen m_originalPen;
+	void setStyle(StrokeStyleTable::Index style);
+
+	std::shared_ptr<StrokeStyleTable> m_styles;
+	StrokeStyleTable::Index m_style;
+	CompactPath m_compactPath;
+	StoredPath m_storedPath;
+	std::unique_ptr<VariableWidthOutline> m_widthOutline;
+	mutable QPainterPath m_shape; // shape() of a compact path, empty until asked for
 };
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "StrokeMerger.h"
+#include "BooleanEngine.h"
+#include <vector>
+
+namespace {
+	// Marks a cell as covered by something no color can be merged through
+	const QRgb BLOCKS_ALL = 0;
+
+	bool isMergeable(const StrokeItem* stroke) {
+		return stroke->color().alpha() == 255 && stroke->effectiveOpacity() >= 1.0;
+	}
+}
+
+StrokeMergeResult StrokeMerger::merge(const QGraphicsScene& scene, const QList<BaseItem*>& candidates) {
+	StrokeMergeResult result;
+	const QSet<BaseItem*> candidateSet(candidates.begin(), candidates.end());
+
+	// Colors seen so far per grid cell, walking down from the topmost item
+	const QRectF bounds = scene.itemsBoundingRect();
+	if (bounds.isEmpty()) return result;
+	const qreal cellWidth = bounds.width() / GRID_SIZE;
+	const qreal cellHeight = bounds.height() / GRID_SIZE;
+	std::vector<QVarLengthArray<QRgb, 2>> cells(GRID_SIZE * GRID_SIZE);
+
+	auto cellRange = [&](const QRectF& rect, QRect& range) {
+		const QRectF local = rect.translated(-bounds.topLeft());
+		range.setCoords(
+			qBound(0, static_cast<int>(local.left() / cellWidth), GRID_SIZE - 1),
+			qBound(0, static_cast<int>(local.top() / cellHeight), GRID_SIZE - 1),
+			qBound(0, static_cast<int>(local.right() / cellWidth), GRID_SIZE - 1),
+			qBound(0, static_cast<int>(local.bottom() / cellHeight), GRID_SIZE - 1));
+	};
+
+	QHash<QRgb, QList<StrokeItem*>> groups;
+	QList<QRgb> groupOrder;
+	for (QGraphicsItem* item : scene.items(Qt::DescendingOrder)) {
+		// Onion skins and other helpers aren't part of the drawing
+		BaseItem* baseItem = dynamic_cast<BaseItem*>(item);
+		if (!baseItem || item->parentItem() || !item->isVisible()) continue;
+
+		StrokeItem* stroke = dynamic_cast<StrokeItem*>(baseItem);
+		const bool mergeable = stroke && isMergeable(stroke);
+		const QRgb color = mergeable ? stroke->color().rgba() : BLOCKS_ALL;
+
+		QRect range;
+		cellRange(item->sceneBoundingRect(), range);
+
+		bool blocked = !mergeable;
+		for (int y = range.top(); y <= range.bottom() && !blocked; y++) {
+			for (int x = range.left(); x <= range.right() && !blocked; x++) {
+				for (QRgb other : cells[y * GRID_SIZE + x]) {
+					if (other != color) {
+						blocked = true;
+						break;
+					}
+				}
+			}
+		}
+
+		if (!blocked && candidateSet.contains(baseItem)) {
+			auto group = groups.find(color);
+			if (group == groups.end()) {
+				group = groups.insert(color, {});
+				groupOrder.append(color);
+			}
+			group->append(stroke);
+		}
+
+		for (int y = range.top(); y <= range.bottom(); y++) {
+			for (int x = range.left(); x <= range.right(); x++) {
+				QVarLengthArray<QRgb, 2>& cell = cells[y * GRID_SIZE + x];
+				if (!cell.contains(color)) cell.append(color);
+			}
+		}
+	}
+
+	// Outlines are read on this thread, the items belong to the scene
+	struct Group {
+		QRgb color;
+		QList<StrokeItem*> items;
+		Clipper2Lib::Paths64 subject;
+		qreal z;
+	};
+	std::vector<Group> work;
+	for (QRgb color : groupOrder) {
+		const QList<StrokeItem*>& items = groups[color];
+		if (items.size() < 2) continue;
+
+		Group group{ color, items, {}, items.first()->zValue() };
+		Clipper2Lib::Paths64 outline;
+		for (StrokeItem* item : items) {
+			item->outlinePaths(outline);
+			group.subject.insert(group.subject.end(), outline.begin(), outline.end());
+			group.z = qMax(group.z, item->zValue());
+		}
+		work.push_back(std::move(group));
+	}
+	if (work.empty()) return result;
+
+	// Groups, and the parts of a group that don't touch, are unioned in parallel
+	std::vector<Clipper2Lib::Paths64> subjects;
+	subjects.reserve(work.size());
+	for (Group& group : work) {
+		subjects.push_back(std::move(group.subject));
+	}
+	const std::vector<Clipper2Lib::Paths64> solutions = BooleanEngine::unite(subjects);
+
+	const std::shared_ptr<StrokeStyleTable> styles = StrokeStyleTable::forScene(&scene);
+	for (size_t i = 0; i < work.size(); i++) {
+		const Group& group = work[i];
+		if (solutions[i].empty()) continue;
+
+		// Scene coordinates, the merged item sits at the origin
+		StrokeItem* merged = new StrokeItem(QColor::fromRgba(group.color), styles);
+		merged->setClipperPaths(solutions[i]);
+		merged->setZValue(group.z);
+
+		result.originals.append(group.items);
+		result.merged.append(merged);
+	}
+	return result;
+}
\ No newline at end of file
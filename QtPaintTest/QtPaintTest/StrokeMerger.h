@@ -0,0 +1,29 @@
+#pragma once
+#include <QtWidgets>
+#include "StrokeItem.h"
+
+struct StrokeMergeResult {
+	QList<StrokeItem*> originals; // Taken out of the scene by the merge
+	QList<StrokeItem*> merged;    // One per merged group, not in any scene yet
+
+	bool isEmpty() const { return merged.isEmpty(); }
+};
+
+// Unions opaque strokes of the same color into as few items as possible. The
+// filled area stays the same: a stroke only joins its color's group if
+// nothing of another color above it overlaps it, so lifting it to the top of
+// the group can't hide or reveal anything. The outlines don't. The merged
+// item is filled and gets the thin darker outline of filled strokes around
+// the union only, so the outlines where strokes overlapped are gone. Strokes
+// that weren't filled yet gain that outline.
+// The groups are unioned by the BooleanEngine, in parallel and split further
+// where their strokes don't touch.
+class StrokeMerger {
+public:
+	// Cells per side of the grid that tracks which colors cover which part of the frame
+	static const int GRID_SIZE = 128;
+
+	// Only candidates are merged, but every item of the scene can block a merge.
+	// Groups of one are left alone.
+	static StrokeMergeResult merge(const QGraphicsScene& scene, const QList<BaseItem*>& candidates);
+};
\ No newline at end of file
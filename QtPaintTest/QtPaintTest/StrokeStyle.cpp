@@ -0,0 +1,69 @@
+#include "StrokeStyle.h"
+
+namespace {
+	QHash<const QGraphicsScene*, std::shared_ptr<StrokeStyleTable>>& sceneTables() {
+		static QHash<const QGraphicsScene*, std::shared_ptr<StrokeStyleTable>> tables;
+		return tables;
+	}
+}
+
+StrokeStyleTable::StrokeStyleTable() {
+	// Index 0 is always valid
+	intern(Qt::black, 1, false);
+}
+
+std::shared_ptr<StrokeStyleTable> StrokeStyleTable::forScene(const QGraphicsScene* scene) {
+	if (!scene) return std::make_shared<StrokeStyleTable>();
+
+	std::shared_ptr<StrokeStyleTable>& table = sceneTables()[scene];
+	if (!table) {
+		table = std::make_shared<StrokeStyleTable>();
+		QObject::connect(scene, &QObject::destroyed, [scene]() { sceneTables().remove(scene); });
+	}
+	return table;
+}
+
+void StrokeStyleTable::resetScene(const QGraphicsScene* scene) {
+	auto it = sceneTables().find(scene);
+	if (it != sceneTables().end()) {
+		*it = std::make_shared<StrokeStyleTable>();
+	}
+}
+
+StrokeStyleTable::Index StrokeStyleTable::intern(const QColor& color, qreal width, bool outlined) {
+	const QRgba64 rgba = color.rgba64();
+	const Key key{ static_cast<quint64>(rgba), width, outlined };
+
+	auto it = m_indices.constFind(key);
+	if (it != m_indices.constEnd()) return it.value();
+
+	// The table grows as needed, a document runs out of memory long before
+	// it runs out of 32-bit indices
+	const Index index = static_cast<Index>(m_styles.size());
+	StrokeStyle& style = m_styles.emplace_back();
+	style.color = QColor::fromRgba64(rgba);
+	style.width = width;
+	style.outlined = outlined;
+
+	if (outlined) {
+		// Filled shape with a thin outline for definition
+		style.brush = QBrush(style.color);
+		style.pen = QPen(style.color.darker(120), 0.5);
+		style.pen.setJoinStyle(Qt::RoundJoin);
+	}
+	else {
+		style.pen = QPen(style.color, width);
+		style.pen.setCapStyle(Qt::RoundCap);
+		style.pen.setJoinStyle(Qt::RoundJoin);
+		// A stroke without width is drawn filled
+		style.brush = width > 0 ? QBrush(Qt::NoBrush) : QBrush(style.color);
+	}
+
+	style.highlightPen = style.pen;
+	style.highlightPen.setColor(Qt::blue);
+	style.highlightPen.setWidthF(style.pen.widthF() + 1);
+	style.highlightPen.setStyle(Qt::DashLine);
+
+	m_indices.insert(key, index);
+	return index;
+}
\ No newline at end of file
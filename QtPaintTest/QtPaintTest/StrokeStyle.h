@@ -0,0 +1,64 @@
+#pragma once
+#include <QtWidgets>
+#include <deque>
+#include <memory>
+
+// Appearance shared by every stroke with the same color, width and fill mode
+struct StrokeStyle {
+	QColor color;
+	qreal width = 0;
+	bool outlined = false;
+
+	// Resolved once when the style is interned, items share these
+	QPen pen;
+	QPen highlightPen; // Drawn while the item is selected
+	QBrush brush;
+};
+
+// Interns stroke styles so items only have to keep an index. Every document
+// has its own table, shared by its items, so the styles of a closed document
+// go with its last item. Indices and the styles they resolve to stay valid as
+// long as the table does.
+// Items are only created on the GUI thread, so the table isn't locked. The
+// worker threads get paths and widths, not items or styles.
+class StrokeStyleTable {
+public:
+	using Index = quint32;
+
+	StrokeStyleTable();
+	StrokeStyleTable(const StrokeStyleTable&) = delete;
+	StrokeStyleTable& operator=(const StrokeStyleTable&) = delete;
+
+	// The table of the document shown in scene, created on first use and
+	// dropped with the scene. Without a scene the items get a table of their
+	// own, they move to the scene's when they're added to one.
+	static std::shared_ptr<StrokeStyleTable> forScene(const QGraphicsScene* scene);
+	// The scene starts a new document. Items still holding the old table,
+	// in the clipboard for instance, keep it alive until they're gone.
+	static void resetScene(const QGraphicsScene* scene);
+
+	Index intern(const QColor& color, qreal width, bool outlined);
+	Index intern(const StrokeStyle& style) { return intern(style.color, style.width, style.outlined); }
+
+	const StrokeStyle& style(Index index) const { return m_styles[index]; }
+	int size() const { return static_cast<int>(m_styles.size()); }
+
+private:
+	struct Key {
+		quint64 color;
+		qreal width;
+		bool outlined;
+
+		bool operator==(const Key& other) const {
+			return color == other.color && width == other.width && outlined == other.outlined;
+		}
+	};
+	friend size_t qHash(const Key& key, size_t seed) {
+		return qHashMulti(seed, key.color, key.width, key.outlined);
+	}
+
+	// A deque grows without moving what it holds, so references returned by
+	// style() survive later interning
+	std::deque<StrokeStyle> m_styles;
+	QHash<Key, Index> m_indices;
+};
\ No newline at end of file
@@ -0,0 +1,333 @@
+#include "SvgExporter.h"
+
+namespace {
+	const int FLUSH_THRESHOLD = 1 << 16;
+
+	// Shortest fixed-point form, used for the few numbers outside the path data
+	QByteArray formatNumber(double value, int precision) {
+		QByteArray text = QByteArray::number(value, 'f', precision);
+		if (text.contains('.')) {
+			while (text.endsWith('0')) text.chop(1);
+			if (text.endsWith('.')) text.chop(1);
+		}
+		return text == "-0" ? QByteArray("0") : text;
+	}
+
+	QByteArray colorName(const QColor& color) {
+		return color.name(QColor::HexRgb).toLatin1();
+	}
+}
+
+SvgExporter::SvgExporter(int precision) : m_precision(qBound(0, precision, 6)), m_scale(1) {
+	for (int i = 0; i < m_precision; i++) {
+		m_scale *= 10;
+	}
+	m_buffer.reserve(2 * FLUSH_THRESHOLD);
+}
+
+QByteArray SvgExporter::styleFor(const FrameSnapshot::Entry& entry) const {
+	QByteArray style;
+
+	if (entry.brush.style() == Qt::NoBrush) {
+		style += "fill:none";
+	}
+	else {
+		const QColor color = entry.brush.color();
+		style += "fill:" + colorName(color);
+		if (color.alpha() < 255) {
+			style += ";fill-opacity:" + formatNumber(color.alphaF(), 3);
+		}
+		// QPainterPath defaults to odd-even filling, SVG to non-zero
+		if (entry.path.fillRule() == Qt::OddEvenFill) {
+			style += ";fill-rule:evenodd";
+		}
+	}
+
+	if (entry.pen.style() == Qt::NoPen) {
+		style += ";stroke:none";
+	}
+	else {
+		const QColor color = entry.pen.color();
+		style += ";stroke:" + colorName(color);
+		if (color.alpha() < 255) {
+			style += ";stroke-opacity:" + formatNumber(color.alphaF(), 3);
+		}
+		if (entry.pen.isCosmetic()) {
+			style += ";stroke-width:" + formatNumber(qMax<qreal>(1.0, entry.pen.widthF()), m_precision);
+			style += ";vector-effect:non-scaling-stroke";
+		}
+		else {
+			style += ";stroke-width:" + formatNumber(entry.pen.widthF(), m_precision);
+		}
+
+		switch (entry.pen.capStyle()) {
+		case Qt::RoundCap: style += ";stroke-linecap:round"; break;
+		case Qt::SquareCap: style += ";stroke-linecap:square"; break;
+		default: break;
+		}
+		switch (entry.pen.joinStyle()) {
+		case Qt::RoundJoin: style += ";stroke-linejoin:round"; break;
+		case Qt::BevelJoin: style += ";stroke-linejoin:bevel"; break;
+		default: break;
+		}
+	}
+
+	if (entry.opacity < 1.0) {
+		style += ";opacity:" + formatNumber(entry.opacity, 3);
+	}
+
+	return style;
+}
+
+void SvgExporter::appendNumber(double value) {
+	// Integer formatting of the value scaled to the requested precision,
+	// much cheaper than going through a floating point formatter
+	qint64 scaled = qRound64(value * m_scale);
+	if (scaled < 0) {
+		m_buffer.append('-');
+		scaled = -scaled;
+	}
+
+	char digits[32];
+	int count = 0;
+	qint64 integer = scaled / m_scale;
+	do {
+		digits[count++] = static_cast<char>('0' + integer % 10);
+		integer /= 10;
+	} while (integer > 0);
+	while (count > 0) {
+		m_buffer.append(digits[--count]);
+	}
+
+	qint64 fraction = scaled % m_scale;
+	if (fraction == 0) return;
+
+	for (int i = m_precision - 1; i >= 0; i--) {
+		digits[i] = static_cast<char>('0' + fraction % 10);
+		fraction /= 10;
+	}
+	int length = m_precision;
+	while (digits[length - 1] == '0') {
+		length--;
+	}
+	m_buffer.append('.');
+	m_buffer.append(digits, length);
+}
+
+void SvgExporter::appendPathData(const QPainterPath& path, const QPointF& offset) {
+	// Numbers only need a separator when they don't follow a command
+	// letter and don't start with a minus sign
+	auto appendValue = [this](double value) {
+		const char last = m_buffer.at(m_buffer.size() - 1);
+		if (qRound64(value * m_scale) >= 0 && !(last >= 'A' && last <= 'Z')) {
+			m_buffer.append(' ');
+		}
+		appendNumber(value);
+	};
+	auto appendPoint = [&](const QPainterPath::Element& element) {
+		appendValue(element.x + offset.x());
+		appendValue(element.y + offset.y());
+	};
+
+	// Repeated commands are implicit, and coordinates after a move are line segments
+	char lastCommand = 0;
+	const int elementCount = path.elementCount();
+	for (int i = 0; i < elementCount; i++) {
+		const QPainterPath::Element& element = path.elementAt(i);
+		switch (element.type) {
+		case QPainterPath::MoveToElement:
+			m_buffer.append('M');
+			appendPoint(element);
+			lastCommand = 'L';
+			break;
+		case QPainterPath::LineToElement:
+			if (lastCommand != 'L') {
+				m_buffer.append('L');
+				lastCommand = 'L';
+			}
+			appendPoint(element);
+			break;
+		case QPainterPath::CurveToElement:
+			if (i + 2 >= elementCount) return;
+			if (lastCommand != 'C') {
+				m_buffer.append('C');
+				lastCommand = 'C';
+			}
+			appendPoint(element);
+			appendPoint(path.elementAt(i + 1));
+			appendPoint(path.elementAt(i + 2));
+			i += 2;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void SvgExporter::appendImage(const FrameSnapshot::Entry& entry) {
+	QByteArray png;
+	QBuffer buffer(&png);
+	buffer.open(QIODevice::WriteOnly);
+	entry.image.save(&buffer, "PNG");
+
+	const QTransform& t = entry.transform;
+	m_buffer.append("<image x=\"" + formatNumber(entry.imageRect.x(), m_precision)
+		+ "\" y=\"" + formatNumber(entry.imageRect.y(), m_precision)
+		+ "\" width=\"" + formatNumber(entry.imageRect.width(), m_precision)
+		+ "\" height=\"" + formatNumber(entry.imageRect.height(), m_precision)
+		+ "\" transform=\"matrix(" + formatNumber(t.m11(), 6) + ' ' + formatNumber(t.m12(), 6) + ' '
+		+ formatNumber(t.m21(), 6) + ' ' + formatNumber(t.m22(), 6) + ' '
+		+ formatNumber(t.dx(), m_precision) + ' ' + formatNumber(t.dy(), m_precision) + ")\"");
+	if (entry.opacity < 1.0) {
+		m_buffer.append(" opacity=\"" + formatNumber(entry.opacity, 3) + '"');
+	}
+	m_buffer.append(" preserveAspectRatio=\"none\" xlink:href=\"data:image/png;base64,");
+	m_buffer.append(png.toBase64());
+	m_buffer.append("\"/>\n");
+}
+
+bool SvgExporter::flush(bool force) {
+	if (!force && m_buffer.size() < FLUSH_THRESHOLD) return true;
+
+	if (m_file.write(m_buffer) != m_buffer.size()) {
+		m_error = "Unable to write " + m_file.fileName() + ": " + m_file.errorString();
+		return false;
+	}
+	m_buffer.truncate(0); // Keeps the capacity for the next chunk
+	return true;
+}
+
+bool SvgExporter::write(const QString& fileName, const QList<FrameSnapshot>& frames, const QSize& size, int frameRate) {
+	m_error.clear();
+	m_buffer.truncate(0);
+	m_styleClasses.clear();
+
+	if (frames.isEmpty()) {
+		m_error = "There is nothing to export";
+		return false;
+	}
+
+	// Collect the styles up front so they can all be declared before the paths
+	QList<QByteArray> styles;
+	QList<int> entryClasses;
+	for (const FrameSnapshot& frame : frames) {
+		for (const FrameSnapshot::Entry& entry : frame.entries) {
+			if (!entry.image.isNull()) continue;
+
+			const QByteArray style = styleFor(entry);
+			auto it = m_styleClasses.constFind(style);
+			if (it == m_styleClasses.constEnd()) {
+				it = m_styleClasses.insert(style, styles.size());
+				styles.append(style);
+			}
+			entryClasses.append(it.value());
+		}
+	}
+
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		m_error = "Unable to open file for writing: " + m_file.errorString();
+		return false;
+	}
+
+	const QRectF sceneRect = frames.first().sceneRect;
+	m_buffer.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.1\"");
+	m_buffer.append(" width=\"" + QByteArray::number(size.width()) + "\" height=\"" + QByteArray::number(size.height()) + '"');
+	m_buffer.append(" viewBox=\"" + formatNumber(sceneRect.x(), m_precision) + ' ' + formatNumber(sceneRect.y(), m_precision) + ' '
+		+ formatNumber(sceneRect.width(), m_precision) + ' ' + formatNumber(sceneRect.height(), m_precision) + "\">\n");
+	m_buffer.append("<title>Qt Vector Drawing</title>\n<desc>Created with Qt Vector Drawing App</desc>\n");
+
+	m_buffer.append("<style>\n");
+	for (int i = 0; i < styles.size(); i++) {
+		m_buffer.append(".s" + QByteArray::number(i) + '{' + styles[i] + "}\n");
+	}
+	m_buffer.append("</style>\n");
+
+	const bool grouped = frames.size() > 1;
+	const bool animated = grouped && frameRate > 0;
+	const int frameCount = frames.size();
+	const QByteArray duration = formatNumber(static_cast<double>(frameCount) / qMax(1, frameRate), 3) + 's';
+
+	int entryIndex = 0;
+	bool ok = true;
+	for (int frameIndex = 0; frameIndex < frameCount && ok; frameIndex++) {
+		const FrameSnapshot& frame = frames[frameIndex];
+
+		if (grouped) {
+			m_buffer.append("<g id=\"frame" + QByteArray::number(frameIndex + 1) + '"');
+			if (animated) {
+				// Viewers without animation support show the first frame
+				m_buffer.append(frameIndex == 0 ? " visibility=\"visible\">\n" : " visibility=\"hidden\">\n");
+				m_buffer.append("<animate attributeName=\"visibility\" calcMode=\"discrete\" repeatCount=\"indefinite\" dur=\"" + duration + '"');
+				const QByteArray start = formatNumber(static_cast<double>(frameIndex) / frameCount, 6);
+				const QByteArray end = formatNumber(static_cast<double>(frameIndex + 1) / frameCount, 6);
+				if (frameIndex == 0) {
+					m_buffer.append(" values=\"visible;hidden\" keyTimes=\"0;" + end + "\"/>\n");
+				}
+				else {
+					m_buffer.append(" values=\"hidden;visible;hidden\" keyTimes=\"0;" + start + ';' + end + "\"/>\n");
+				}
+			}
+			else {
+				m_buffer.append(">\n");
+			}
+		}
+
+		if (frame.background.style() != Qt::NoBrush) {
+			m_buffer.append("<rect x=\"" + formatNumber(frame.sceneRect.x(), m_precision)
+				+ "\" y=\"" + formatNumber(frame.sceneRect.y(), m_precision)
+				+ "\" width=\"" + formatNumber(frame.sceneRect.width(), m_precision)
+				+ "\" height=\"" + formatNumber(frame.sceneRect.height(), m_precision)
+				+ "\" fill=\"" + colorName(frame.background.color()) + "\"/>\n");
+		}
+
+		for (const FrameSnapshot::Entry& entry : frame.entries) {
+			if (!entry.image.isNull()) {
+				appendImage(entry);
+			}
+			else {
+				m_buffer.append("<path class=\"s");
+				m_buffer.append(QByteArray::number(entryClasses[entryIndex++]));
+				m_buffer.append('"');
+
+				// Translations are folded into the coordinates, anything else stays a transform
+				QPointF offset;
+				const QTransform& t = entry.transform;
+				if (t.type() <= QTransform::TxTranslate) {
+					offset = QPointF(t.dx(), t.dy());
+				}
+				else {
+					m_buffer.append(" transform=\"matrix(" + formatNumber(t.m11(), 6) + ' ' + formatNumber(t.m12(), 6) + ' '
+						+ formatNumber(t.m21(), 6) + ' ' + formatNumber(t.m22(), 6) + ' '
+						+ formatNumber(t.dx(), m_precision) + ' ' + formatNumber(t.dy(), m_precision) + ")\"");
+				}
+
+				m_buffer.append(" d=\"");
+				appendPathData(entry.path, offset);
+				m_buffer.append("\"/>\n");
+			}
+
+			if (!flush()) {
+				ok = false;
+				break;
+			}
+		}
+
+		if (grouped) {
+			m_buffer.append("</g>\n");
+		}
+	}
+
+	if (ok) {
+		m_buffer.append("</svg>\n");
+		ok = flush(true);
+	}
+
+	m_file.close();
+	if (!ok) {
+		m_file.remove();
+	}
+	m_buffer.truncate(0);
+	return ok;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include <QtWidgets>
+#include "FrameExporter.h"
+
+// Writes frame snapshots as plain SVG: one <path> per stroke, styles shared
+// through CSS classes and coordinates with a fixed number of decimals.
+// The output is assembled in a buffer that is flushed to the file as it fills
+// up, so memory use doesn't grow with the drawing.
+class SvgExporter {
+public:
+	explicit SvgExporter(int precision = 2);
+
+	// With more than one frame every frame goes into its own <g> group.
+	// A frame rate above 0 also animates the groups so only one is visible at a time.
+	bool write(const QString& fileName, const QList<FrameSnapshot>& frames, const QSize& size, int frameRate = 0);
+
+	QString errorString() const { return m_error; }
+
+private:
+	QByteArray styleFor(const FrameSnapshot::Entry& entry) const;
+
+	void appendNumber(double value);
+	void appendPathData(const QPainterPath& path, const QPointF& offset);
+	void appendImage(const FrameSnapshot::Entry& entry);
+	bool flush(bool force = false);
+
+	QFile m_file;
+	QByteArray m_buffer;
+	QHash<QByteArray, int> m_styleClasses;
+	int m_precision;
+	qint64 m_scale;
+	QString m_error;
+};
\ No newline at end of file
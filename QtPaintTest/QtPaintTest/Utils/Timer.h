@@ -4,6 +4,7 @@
 #include <cstdlib>
 #include <string>
 #include <chrono> 
+#include <cmath>
 #include <iomanip>
 #include <sstream>
 
@@ -30,8 +31,6 @@ Example:
 
 struct Timer {
 private:
-  std::streamsize old_precision = std::cout.precision(0);
-  std::ios_base::fmtflags old_flags = std::cout.flags();
   std::chrono::high_resolution_clock::time_point time_started_;
   std::chrono::high_resolution_clock::duration duration_ = {};
   bool paused_ = false;
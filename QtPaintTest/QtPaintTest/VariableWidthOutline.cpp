@@ -0,0 +1,92 @@
+#include "VariableWidthOutline.h"
+#include "DrawingEngineUtils.h"
+#include <cmath>
+
+namespace {
+	const qreal ARC_TOLERANCE = 0.1;   // Largest gap between an arc and its polygon, scene units
+	const qreal MIN_SPACING = 0.5;     // Samples closer than this to the last one are skipped
+
+	// Points from angle a0 to a1, both ends included
+	void appendArc(QPolygonF& polygon, const QPointF& center, qreal radius, qreal a0, qreal a1) {
+		const qreal step = radius <= ARC_TOLERANCE ? M_PI / 2 : qMin(M_PI / 4, 2 * std::acos(1 - ARC_TOLERANCE / radius));
+		const int count = qMax(1, static_cast<int>(std::ceil((a1 - a0) / step)));
+		for (int i = 0; i <= count; i++) {
+			const qreal angle = a0 + (a1 - a0) * i / count;
+			polygon << center + QPointF(std::cos(angle), std::sin(angle)) * radius;
+		}
+	}
+}
+
+void VariableWidthOutline::addSample(const QPointF& pos, qreal width) {
+	const qreal radius = qMax<qreal>(width, 0) / 2;
+	m_bounds |= QRectF(pos.x() - radius, pos.y() - radius, 2 * radius, 2 * radius);
+
+	if (m_sampleCount == 0) {
+		addHull(pos, radius, pos, radius); // A dot until the next sample comes
+	}
+	else {
+		if (QLineF(m_lastPos, pos).length() < MIN_SPACING) return;
+		addHull(m_lastPos, m_lastWidth / 2, pos, radius);
+	}
+
+	m_lastPos = pos;
+	m_lastWidth = qMax<qreal>(width, 0);
+	m_sampleCount++;
+
+	if (static_cast<int>(m_open.size()) >= CHUNK_SEGMENTS) {
+		closeChunk();
+	}
+}
+
+void VariableWidthOutline::addHull(const QPointF& c0, qreal r0, const QPointF& c1, qreal r1) {
+	QPolygonF hull;
+	const QPointF delta = c1 - c0;
+	const qreal distance = std::hypot(delta.x(), delta.y());
+	if (distance <= qAbs(r1 - r0)) {
+		// One circle holds the other
+		const QPointF& center = r0 > r1 ? c0 : c1;
+		appendArc(hull, center, qMax(r0, r1), 0, 2 * M_PI);
+		hull.removeLast();
+	}
+	else {
+		// The outer tangents touch both circles at the same angle from the
+		// direction of travel, the front of the new circle and the back of
+		// the old one make up the hull
+		const qreal direction = std::atan2(delta.y(), delta.x());
+		const qreal tangent = std::acos(qBound<qreal>(-1, (r0 - r1) / distance, 1));
+		appendArc(hull, c1, r1, direction - tangent, direction + tangent);
+		appendArc(hull, c0, r0, direction + tangent, direction + 2 * M_PI - tangent);
+	}
+
+	m_open.emplace_back();
+	DrawingEngineUtils::convertPolygonToClipper(hull, m_open.back());
+	m_preview.setFillRule(Qt::WindingFill);
+	m_preview.addPolygon(hull);
+	m_preview.closeSubpath();
+}
+
+void VariableWidthOutline::closeChunk() {
+	Clipper2Lib::Clipper64 clipper;
+	clipper.AddSubject(m_open);
+	Clipper2Lib::Paths64 chunk;
+	clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, chunk);
+
+	DrawingEngineUtils::appendClipperPaths(chunk, m_chunkPreview);
+	for (Clipper2Lib::Path64& contour : chunk) {
+		m_chunks.push_back(std::move(contour));
+	}
+	m_open.clear();
+
+	// The open hulls are now part of the chunks, copied once per chunk
+	m_preview = m_chunkPreview;
+	m_preview.setFillRule(Qt::WindingFill);
+}
+
+Clipper2Lib::Paths64 VariableWidthOutline::outline() const {
+	Clipper2Lib::Clipper64 clipper;
+	clipper.AddSubject(m_chunks);
+	clipper.AddSubject(m_open);
+	Clipper2Lib::Paths64 solution;
+	clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, solution);
+	return solution;
+}
\ No newline at end of file
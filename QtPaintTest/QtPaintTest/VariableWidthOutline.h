@@ -0,0 +1,37 @@
+#pragma once
+#include <QtWidgets>
+#include <clipper2/clipper.h>
+
+// Outline of a stroke whose width changes from one sample to the next, built
+// while the stroke is drawn. Each pair of samples adds the hull of their two
+// circles, and every CHUNK_SEGMENTS hulls are unioned into one polygon, so
+// finishing the stroke only has to union a few chunks.
+class VariableWidthOutline {
+public:
+	static const int CHUNK_SEGMENTS = 32;
+
+	void addSample(const QPointF& pos, qreal width);
+	bool isEmpty() const { return m_sampleCount == 0; }
+	QRectF boundingRect() const { return m_bounds; }
+
+	// What has been drawn so far, for painting. Hulls of the open chunk can
+	// overlap, the path uses the winding fill rule. Kept up to date as samples
+	// come in, so painting doesn't rebuild it.
+	const QPainterPath& preview() const { return m_preview; }
+	// The whole outline as one union, in item coordinates scaled by CLIPPER_SCALING
+	Clipper2Lib::Paths64 outline() const;
+
+private:
+	void addHull(const QPointF& c0, qreal r0, const QPointF& c1, qreal r1);
+	void closeChunk();
+
+	int m_sampleCount = 0;
+	QPointF m_lastPos;
+	qreal m_lastWidth = 0;
+	QRectF m_bounds;
+
+	Clipper2Lib::Paths64 m_chunks;  // Unions of the closed chunks
+	Clipper2Lib::Paths64 m_open;    // Hulls of the chunk being drawn
+	QPainterPath m_chunkPreview; // The closed chunks only
+	QPainterPath m_preview;      // The closed chunks plus the open hulls
+};
\ No newline at end of file
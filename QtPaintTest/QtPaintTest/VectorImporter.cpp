@@ -0,0 +1,751 @@
+#include "VectorImporter.h"
+#include "Utils/ClipFileLoad.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+	// Shapes are only turned into paths by the parser threads above this count
+	const int PARALLEL_PARSE_THRESHOLD = 256;
+	const int PARSE_CHUNK_SIZE = 512;
+
+	// Inherited presentation state of an SVG element
+	struct SvgStyle {
+		QColor fill = Qt::black;
+		bool hasFill = true;
+		QColor stroke = Qt::black;
+		bool hasStroke = false;
+		qreal strokeWidth = 1.0;
+		qreal fillOpacity = 1.0;
+		qreal strokeOpacity = 1.0;
+		qreal opacity = 1.0;
+		Qt::FillRule fillRule = Qt::WindingFill;
+		bool visible = true;
+		QTransform transform;
+	};
+
+	using StyleRules = QHash<QString, QList<QPair<QString, QString>>>;
+
+	// One shape waiting to become StrokeItems. Path elements keep their raw
+	// data so it can be parsed on the worker threads.
+	struct ShapeRecord {
+		QString pathData;
+		QPainterPath path;
+		SvgStyle style;
+	};
+
+	inline bool isSeparator(QChar c) {
+		return c == ',' || c.isSpace();
+	}
+
+	inline bool isDigit(QChar c) {
+		return c >= '0' && c <= '9';
+	}
+
+	inline void skipSeparators(const QChar*& p, const QChar* end) {
+		while (p < end && isSeparator(*p)) ++p;
+	}
+
+	// Hand written so path data doesn't need to be split into strings first
+	bool readNumber(const QChar*& p, const QChar* end, double& value) {
+		skipSeparators(p, end);
+		const QChar* start = p;
+
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+')) {
+			negative = *p == '-';
+			++p;
+		}
+
+		double mantissa = 0;
+		int exponent = 0;
+		int digits = 0;
+		while (p < end && isDigit(*p)) {
+			mantissa = mantissa * 10 + (p->unicode() - '0');
+			++digits;
+			++p;
+		}
+		if (p < end && *p == '.') {
+			++p;
+			while (p < end && isDigit(*p)) {
+				mantissa = mantissa * 10 + (p->unicode() - '0');
+				--exponent;
+				++digits;
+				++p;
+			}
+		}
+		if (digits == 0) {
+			p = start;
+			return false;
+		}
+
+		// Only an exponent if digits follow, "1e" is a number followed by garbage
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			const QChar* q = p + 1;
+			bool negativeExponent = false;
+			if (q < end && (*q == '-' || *q == '+')) {
+				negativeExponent = *q == '-';
+				++q;
+			}
+			if (q < end && isDigit(*q)) {
+				int explicitExponent = 0;
+				while (q < end && isDigit(*q)) {
+					explicitExponent = qMin(explicitExponent * 10 + (q->unicode() - '0'), 1000);
+					++q;
+				}
+				exponent += negativeExponent ? -explicitExponent : explicitExponent;
+				p = q;
+			}
+		}
+
+		value = exponent < 0 ? mantissa / std::pow(10.0, -exponent) : mantissa * std::pow(10.0, exponent);
+		if (negative) value = -value;
+		return true;
+	}
+
+	bool readNumbers(const QChar*& p, const QChar* end, double* values, int count) {
+		for (int i = 0; i < count; i++) {
+			if (!readNumber(p, end, values[i])) return false;
+		}
+		return true;
+	}
+
+	// Arc flags are single digits and may be written without separators
+	bool readFlag(const QChar*& p, const QChar* end, bool& flag) {
+		skipSeparators(p, end);
+		if (p == end || (*p != '0' && *p != '1')) return false;
+		flag = *p == '1';
+		++p;
+		return true;
+	}
+
+	bool isPathCommand(QChar c) {
+		switch (c.unicode()) {
+		case 'M': case 'm': case 'L': case 'l': case 'H': case 'h': case 'V': case 'v':
+		case 'C': case 'c': case 'S': case 's': case 'Q': case 'q': case 'T': case 't':
+		case 'A': case 'a': case 'Z': case 'z':
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// Endpoint to center parameterization from the SVG spec, then one cubic per quarter turn
+	void arcTo(QPainterPath& path, const QPointF& from, qreal rx, qreal ry, qreal angle,
+		bool largeArc, bool sweep, const QPointF& to) {
+		if (from == to) return;
+
+		rx = qAbs(rx);
+		ry = qAbs(ry);
+		if (qFuzzyIsNull(rx) || qFuzzyIsNull(ry)) {
+			path.lineTo(to);
+			return;
+		}
+
+		const qreal phi = qDegreesToRadians(angle);
+		const qreal cosPhi = std::cos(phi);
+		const qreal sinPhi = std::sin(phi);
+
+		const qreal dx = (from.x() - to.x()) / 2;
+		const qreal dy = (from.y() - to.y()) / 2;
+		const qreal x1 = cosPhi * dx + sinPhi * dy;
+		const qreal y1 = -sinPhi * dx + cosPhi * dy;
+
+		// Radii that are too small are scaled up until the arc fits
+		const qreal lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+		if (lambda > 1) {
+			rx *= std::sqrt(lambda);
+			ry *= std::sqrt(lambda);
+		}
+
+		const qreal numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+		const qreal denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+		qreal coefficient = denominator > 0 ? std::sqrt(qMax<qreal>(0, numerator / denominator)) : 0;
+		if (largeArc == sweep) coefficient = -coefficient;
+
+		const qreal cxp = coefficient * rx * y1 / ry;
+		const qreal cyp = -coefficient * ry * x1 / rx;
+		const qreal cx = cosPhi * cxp - sinPhi * cyp + (from.x() + to.x()) / 2;
+		const qreal cy = sinPhi * cxp + cosPhi * cyp + (from.y() + to.y()) / 2;
+
+		auto angleBetween = [](qreal ux, qreal uy, qreal vx, qreal vy) {
+			return std::atan2(ux * vy - uy * vx, ux * vx + uy * vy);
+		};
+		const qreal startAngle = angleBetween(1, 0, (x1 - cxp) / rx, (y1 - cyp) / ry);
+		qreal sweepAngle = angleBetween((x1 - cxp) / rx, (y1 - cyp) / ry, (-x1 - cxp) / rx, (-y1 - cyp) / ry);
+		if (!sweep && sweepAngle > 0) sweepAngle -= 2 * M_PI;
+		else if (sweep && sweepAngle < 0) sweepAngle += 2 * M_PI;
+
+		auto map = [&](qreal ux, qreal uy) {
+			return QPointF(cx + rx * ux * cosPhi - ry * uy * sinPhi, cy + rx * ux * sinPhi + ry * uy * cosPhi);
+		};
+
+		const int segments = qMax(1, static_cast<int>(std::ceil(qAbs(sweepAngle) / (M_PI / 2) - 1e-9)));
+		const qreal step = sweepAngle / segments;
+		const qreal t = 4.0 / 3.0 * std::tan(step / 4);
+		for (int i = 0; i < segments; i++) {
+			const qreal a1 = startAngle + i * step;
+			const qreal a2 = a1 + step;
+			const qreal cos1 = std::cos(a1), sin1 = std::sin(a1);
+			const qreal cos2 = std::cos(a2), sin2 = std::sin(a2);
+			path.cubicTo(map(cos1 - t * sin1, sin1 + t * cos1),
+				map(cos2 + t * sin2, sin2 - t * cos2),
+				i == segments - 1 ? to : map(cos2, sin2));
+		}
+	}
+
+	QList<double> readNumberList(QStringView text) {
+		QList<double> values;
+		const QChar* p = text.data();
+		const QChar* end = p + text.size();
+		double value;
+		while (readNumber(p, end, value)) {
+			values.append(value);
+		}
+		return values;
+	}
+
+	qreal parseLength(QStringView text, qreal fallback = 0) {
+		const QChar* p = text.data();
+		double value;
+		// Units other than user units are rare in exported assets and are treated as pixels
+		return readNumber(p, p + text.size(), value) ? value : fallback;
+	}
+
+	qreal parseOpacity(QStringView text) {
+		text = text.trimmed();
+		qreal value = parseLength(text, 1.0);
+		if (text.endsWith('%')) value /= 100;
+		return qBound<qreal>(0, value, 1);
+	}
+
+	QTransform parseTransform(QStringView text) {
+		QTransform result;
+		qsizetype pos = 0;
+		while (pos < text.size()) {
+			const qsizetype open = text.indexOf('(', pos);
+			if (open < 0) break;
+			const qsizetype close = text.indexOf(')', open);
+			if (close < 0) break;
+
+			const QStringView name = text.mid(pos, open - pos).trimmed();
+			const QList<double> args = readNumberList(text.mid(open + 1, close - open - 1));
+			pos = close + 1;
+			while (pos < text.size() && isSeparator(text[pos])) ++pos;
+
+			QTransform t;
+			if (name == u"matrix" && args.size() == 6) {
+				t = QTransform(args[0], args[1], args[2], args[3], args[4], args[5]);
+			}
+			else if (name == u"translate" && !args.isEmpty()) {
+				t.translate(args[0], args.size() > 1 ? args[1] : 0);
+			}
+			else if (name == u"scale" && !args.isEmpty()) {
+				t.scale(args[0], args.size() > 1 ? args[1] : args[0]);
+			}
+			else if (name == u"rotate" && !args.isEmpty()) {
+				if (args.size() == 3) {
+					t.translate(args[1], args[2]);
+					t.rotate(args[0]);
+					t.translate(-args[1], -args[2]);
+				}
+				else {
+					t.rotate(args[0]);
+				}
+			}
+			else if (name == u"skewX" && !args.isEmpty()) {
+				t = QTransform(1, 0, std::tan(qDegreesToRadians(args[0])), 1, 0, 0);
+			}
+			else if (name == u"skewY" && !args.isEmpty()) {
+				t = QTransform(1, std::tan(qDegreesToRadians(args[0])), 0, 1, 0, 0);
+			}
+
+			// The last transform in the list is applied first
+			result = t * result;
+		}
+		return result;
+	}
+
+	bool parsePaint(QStringView text, QColor& color) {
+		text = text.trimmed();
+		if (text == u"none" || text.isEmpty()) return false;
+		if (text == u"currentColor") {
+			color = Qt::black;
+			return true;
+		}
+		if (text.startsWith(u"url(")) {
+			// Gradients and patterns fall back to the color after the reference, or gray
+			const qsizetype close = text.indexOf(')');
+			if (close < 0 || close + 1 >= text.size()) {
+				color = Qt::gray;
+				return true;
+			}
+			return parsePaint(text.mid(close + 1), color);
+		}
+		if (text.startsWith(u"rgb")) {
+			const qsizetype open = text.indexOf('(');
+			const qsizetype close = text.indexOf(')');
+			if (open < 0 || close < open) return false;
+
+			const QStringView argsText = text.mid(open + 1, close - open - 1);
+			const QList<double> args = readNumberList(argsText);
+			if (args.size() < 3) return false;
+			const qreal scale = argsText.contains('%') ? 255.0 / 100.0 : 1.0;
+			color = QColor(qBound(0, qRound(args[0] * scale), 255),
+				qBound(0, qRound(args[1] * scale), 255),
+				qBound(0, qRound(args[2] * scale), 255));
+			if (args.size() > 3) color.setAlphaF(qBound<qreal>(0, args[3], 1));
+			return true;
+		}
+
+		color = QColor::fromString(text);
+		return color.isValid();
+	}
+
+	void applyProperty(SvgStyle& style, QStringView name, QStringView value) {
+		value = value.trimmed();
+		if (value == u"inherit") return;
+
+		if (name == u"fill") {
+			style.hasFill = parsePaint(value, style.fill);
+		}
+		else if (name == u"stroke") {
+			style.hasStroke = parsePaint(value, style.stroke);
+		}
+		else if (name == u"stroke-width") {
+			style.strokeWidth = parseLength(value, 1.0);
+		}
+		else if (name == u"fill-opacity") {
+			style.fillOpacity = parseOpacity(value);
+		}
+		else if (name == u"stroke-opacity") {
+			style.strokeOpacity = parseOpacity(value);
+		}
+		else if (name == u"opacity") {
+			style.opacity = parseOpacity(value);
+		}
+		else if (name == u"fill-rule") {
+			style.fillRule = value == u"evenodd" ? Qt::OddEvenFill : Qt::WindingFill;
+		}
+		else if (name == u"display") {
+			if (value == u"none") style.visible = false;
+		}
+		else if (name == u"visibility") {
+			style.visible = value == u"visible";
+		}
+	}
+
+	void applyDeclarations(SvgStyle& style, QStringView declarations) {
+		for (QStringView declaration : declarations.split(';')) {
+			const qsizetype colon = declaration.indexOf(':');
+			if (colon < 0) continue;
+			applyProperty(style, declaration.left(colon).trimmed(), declaration.mid(colon + 1));
+		}
+	}
+
+	// Only class selectors are supported, which is what most exporters produce
+	void parseStyleSheet(QString text, StyleRules& rules) {
+		static const QRegularExpression comments("/\\*.*?\\*/", QRegularExpression::DotMatchesEverythingOption);
+		text.remove(comments);
+
+		qsizetype pos = 0;
+		while (true) {
+			const qsizetype open = text.indexOf('{', pos);
+			if (open < 0) break;
+			const qsizetype close = text.indexOf('}', open);
+			if (close < 0) break;
+
+			QList<QPair<QString, QString>> declarations;
+			for (QStringView declaration : QStringView(text).mid(open + 1, close - open - 1).split(';')) {
+				const qsizetype colon = declaration.indexOf(':');
+				if (colon < 0) continue;
+				declarations.append({ declaration.left(colon).trimmed().toString(), declaration.mid(colon + 1).trimmed().toString() });
+			}
+
+			for (QStringView selector : QStringView(text).mid(pos, open - pos).split(',')) {
+				selector = selector.trimmed();
+				if (selector.startsWith('.')) {
+					rules[selector.mid(1).toString()].append(declarations);
+				}
+			}
+			pos = close + 1;
+		}
+	}
+
+	SvgStyle resolveStyle(const SvgStyle& parent, const QXmlStreamAttributes& attributes, const StyleRules& rules) {
+		SvgStyle style = parent;
+		// The element's own opacity, each layer below replaces it. It's combined
+		// with the groups' opacity once all of them are applied.
+		style.opacity = 1.0;
+
+		// Presentation attributes are overridden by style sheets, which are overridden by the style attribute
+		static const char* const properties[] = { "fill", "stroke", "stroke-width", "fill-opacity",
+			"stroke-opacity", "opacity", "fill-rule", "display", "visibility" };
+		for (const char* property : properties) {
+			const QString name = QString::fromLatin1(property);
+			if (attributes.hasAttribute(name)) {
+				applyProperty(style, name, attributes.value(name));
+			}
+		}
+
+		if (!rules.isEmpty() && attributes.hasAttribute("class")) {
+			for (QStringView className : attributes.value("class").split(' ', Qt::SkipEmptyParts)) {
+				auto it = rules.constFind(className.toString());
+				if (it == rules.constEnd()) continue;
+				for (const auto& declaration : it.value()) {
+					applyProperty(style, declaration.first, declaration.second);
+				}
+			}
+		}
+
+		if (attributes.hasAttribute("style")) {
+			applyDeclarations(style, attributes.value("style"));
+		}
+		style.opacity *= parent.opacity;
+
+		if (attributes.hasAttribute("transform")) {
+			style.transform = parseTransform(attributes.value("transform")) * parent.transform;
+		}
+
+		return style;
+	}
+
+	qreal attributeLength(const QXmlStreamAttributes& attributes, const char* name) {
+		return parseLength(attributes.value(QLatin1String(name)));
+	}
+
+	// Builds the path of anything that isn't a <path>, these are cheap enough to do while reading
+	bool buildBasicShape(QStringView element, const QXmlStreamAttributes& attributes, QPainterPath& path) {
+		if (element == u"rect") {
+			const QRectF rect(attributeLength(attributes, "x"), attributeLength(attributes, "y"),
+				attributeLength(attributes, "width"), attributeLength(attributes, "height"));
+			if (rect.isEmpty()) return false;
+
+			qreal rx = attributeLength(attributes, "rx");
+			qreal ry = attributeLength(attributes, "ry");
+			if (!attributes.hasAttribute("rx")) rx = ry;
+			if (!attributes.hasAttribute("ry")) ry = rx;
+			if (rx > 0 && ry > 0) {
+				path.addRoundedRect(rect, qMin(rx, rect.width() / 2), qMin(ry, rect.height() / 2));
+			}
+			else {
+				path.addRect(rect);
+			}
+			return true;
+		}
+		if (element == u"circle" || element == u"ellipse") {
+			const QPointF center(attributeLength(attributes, "cx"), attributeLength(attributes, "cy"));
+			const qreal rx = element == u"circle" ? attributeLength(attributes, "r") : attributeLength(attributes, "rx");
+			const qreal ry = element == u"circle" ? rx : attributeLength(attributes, "ry");
+			if (rx <= 0 || ry <= 0) return false;
+			path.addEllipse(center, rx, ry);
+			return true;
+		}
+		if (element == u"line") {
+			path.moveTo(attributeLength(attributes, "x1"), attributeLength(attributes, "y1"));
+			path.lineTo(attributeLength(attributes, "x2"), attributeLength(attributes, "y2"));
+			return true;
+		}
+		if (element == u"polyline" || element == u"polygon") {
+			const QList<double> points = readNumberList(attributes.value("points"));
+			if (points.size() < 4) return false;
+
+			path.moveTo(points[0], points[1]);
+			for (qsizetype i = 2; i + 1 < points.size(); i += 2) {
+				path.lineTo(points[i], points[i + 1]);
+			}
+			if (element == u"polygon") path.closeSubpath();
+			return true;
+		}
+		return false;
+	}
+
+	bool isContainer(QStringView element) {
+		return element == u"svg" || element == u"g" || element == u"a" || element == u"switch";
+	}
+
+	QColor withOpacity(QColor color, qreal opacity) {
+		color.setAlphaF(color.alphaF() * opacity);
+		return color;
+	}
+
+	QPainterPath clipperPathsToPainterPath(const Clipper2Lib::Paths64& paths, bool closed) {
+		QPainterPath result;
+		for (const Clipper2Lib::Path64& path : paths) {
+			if (path.empty()) continue;
+			result.moveTo(path[0].x, path[0].y);
+			for (size_t i = 1; i < path.size(); i++) {
+				result.lineTo(path[i].x, path[i].y);
+			}
+			if (closed && path.size() > 2) result.closeSubpath();
+		}
+		return result;
+	}
+}
+
+QPainterPath VectorImporter::parsePathData(QStringView data) {
+	QPainterPath path;
+	const QChar* p = data.data();
+	const QChar* end = p + data.size();
+
+	QPointF current;
+	QPointF subpathStart;
+	QPointF lastControl;
+	char command = 0;
+	char lastSegment = 0; // Previous command in upper case, for the smooth curve variants
+	double v[7];
+
+	while (true) {
+		skipSeparators(p, end);
+		if (p == end) break;
+
+		if (isPathCommand(*p)) {
+			command = static_cast<char>(p->unicode());
+			++p;
+		}
+		else if (command == 0 || command == 'Z' || command == 'z') {
+			break; // Numbers without a command
+		}
+
+		const bool relative = command >= 'a';
+		const QPointF origin = relative ? current : QPointF();
+		const char segment = relative ? static_cast<char>(command - 'a' + 'A') : command;
+
+		switch (segment) {
+		case 'M':
+			if (!readNumbers(p, end, v, 2)) return path;
+			current = origin + QPointF(v[0], v[1]);
+			subpathStart = current;
+			path.moveTo(current);
+			command = relative ? 'l' : 'L'; // Coordinates after a move are line segments
+			break;
+		case 'L':
+			if (!readNumbers(p, end, v, 2)) return path;
+			current = origin + QPointF(v[0], v[1]);
+			path.lineTo(current);
+			break;
+		case 'H':
+			if (!readNumbers(p, end, v, 1)) return path;
+			current.setX(relative ? current.x() + v[0] : v[0]);
+			path.lineTo(current);
+			break;
+		case 'V':
+			if (!readNumbers(p, end, v, 1)) return path;
+			current.setY(relative ? current.y() + v[0] : v[0]);
+			path.lineTo(current);
+			break;
+		case 'C':
+			if (!readNumbers(p, end, v, 6)) return path;
+			lastControl = origin + QPointF(v[2], v[3]);
+			path.cubicTo(origin + QPointF(v[0], v[1]), lastControl, origin + QPointF(v[4], v[5]));
+			current = origin + QPointF(v[4], v[5]);
+			break;
+		case 'S': {
+			if (!readNumbers(p, end, v, 4)) return path;
+			const QPointF control1 = (lastSegment == 'C' || lastSegment == 'S') ? 2 * current - lastControl : current;
+			lastControl = origin + QPointF(v[0], v[1]);
+			current = origin + QPointF(v[2], v[3]);
+			path.cubicTo(control1, lastControl, current);
+			break;
+		}
+		case 'Q':
+			if (!readNumbers(p, end, v, 4)) return path;
+			lastControl = origin + QPointF(v[0], v[1]);
+			current = origin + QPointF(v[2], v[3]);
+			path.quadTo(lastControl, current);
+			break;
+		case 'T':
+			if (!readNumbers(p, end, v, 2)) return path;
+			lastControl = (lastSegment == 'Q' || lastSegment == 'T') ? 2 * current - lastControl : current;
+			current = origin + QPointF(v[0], v[1]);
+			path.quadTo(lastControl, current);
+			break;
+		case 'A': {
+			bool largeArc, sweep;
+			if (!readNumbers(p, end, v, 3) || !readFlag(p, end, largeArc) || !readFlag(p, end, sweep)
+				|| !readNumbers(p, end, v + 3, 2)) {
+				return path;
+			}
+			const QPointF target = origin + QPointF(v[3], v[4]);
+			arcTo(path, current, v[0], v[1], v[2], largeArc, sweep, target);
+			current = target;
+			break;
+		}
+		case 'Z':
+			path.closeSubpath();
+			current = subpathStart;
+			break;
+		default:
+			return path;
+		}
+
+		lastSegment = segment;
+	}
+
+	return path;
+}
+
+QList<StrokeItem*> VectorImporter::importSvg(const QString& fileName, QString* errorString) {
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly)) {
+		if (errorString) *errorString = "Unable to open file: " + file.errorString();
+		return {};
+	}
+
+	QXmlStreamReader reader(&file);
+	StyleRules rules;
+	QList<SvgStyle> styleStack{ SvgStyle() };
+	std::vector<ShapeRecord> records;
+
+	while (!reader.atEnd()) {
+		reader.readNext();
+
+		// Everything except containers is read or skipped as a whole, so only containers end here
+		if (reader.isEndElement()) {
+			if (styleStack.size() > 1) styleStack.removeLast();
+			continue;
+		}
+		if (!reader.isStartElement()) continue;
+
+		const QStringView element = reader.name();
+		if (element == u"style") {
+			parseStyleSheet(reader.readElementText(QXmlStreamReader::IncludeChildElements), rules);
+			continue;
+		}
+
+		const SvgStyle style = resolveStyle(styleStack.last(), reader.attributes(), rules);
+		if (isContainer(element)) {
+			styleStack.append(style);
+			continue;
+		}
+
+		// Definitions, text and anything else unsupported are skipped with their children
+		const bool drawn = style.visible && (style.hasFill || style.hasStroke);
+		if (drawn && element == u"path") {
+			records.push_back({ reader.attributes().value("d").toString(), QPainterPath(), style });
+		}
+		else if (drawn) {
+			QPainterPath path;
+			if (buildBasicShape(element, reader.attributes(), path)) {
+				records.push_back({ QString(), path, style });
+			}
+		}
+		reader.skipCurrentElement();
+	}
+
+	if (reader.hasError()) {
+		if (errorString) {
+			*errorString = QString("Invalid SVG file (line %1): %2").arg(reader.lineNumber()).arg(reader.errorString());
+		}
+		return {};
+	}
+
+	// Path data is parsed and transformed into place in chunks on all cores
+	auto buildPaths = [&records](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++) {
+			ShapeRecord& record = records[i];
+			if (!record.pathData.isEmpty()) {
+				record.path = parsePathData(record.pathData);
+				record.pathData.clear();
+			}
+			if (!record.style.transform.isIdentity()) {
+				record.path = record.style.transform.map(record.path);
+			}
+			record.path.setFillRule(record.style.fillRule);
+		}
+	};
+
+	if (records.size() < static_cast<size_t>(PARALLEL_PARSE_THRESHOLD)) {
+		buildPaths(0, records.size());
+	}
+	else {
+		QThreadPool pool;
+		pool.setMaxThreadCount(QThread::idealThreadCount());
+		for (size_t first = 0; first < records.size(); first += PARSE_CHUNK_SIZE) {
+			const size_t last = qMin(first + PARSE_CHUNK_SIZE, records.size());
+			pool.start([&buildPaths, first, last]() { buildPaths(first, last); });
+		}
+		pool.waitForDone();
+	}
+
+	// The items switch to the scene's style table once they're added to it
+	const std::shared_ptr<StrokeStyleTable> styles = StrokeStyleTable::forScene(nullptr);
+	QList<StrokeItem*> items;
+	items.reserve(static_cast<qsizetype>(records.size()));
+	for (const ShapeRecord& record : records) {
+		if (record.path.isEmpty()) continue;
+		const SvgStyle& style = record.style;
+
+		if (style.hasFill) {
+			StrokeItem* item = new StrokeItem(withOpacity(style.fill, style.fillOpacity * style.opacity), 0, styles);
+			item->setGeometry(record.path);
+			item->setOutlined(true);
+			items.append(item);
+		}
+		if (style.hasStroke && style.strokeWidth > 0) {
+			// The transform is already applied to the path, so it's applied to the width here
+			const qreal scale = std::sqrt(qAbs(style.transform.determinant()));
+			StrokeItem* item = new StrokeItem(withOpacity(style.stroke, style.strokeOpacity * style.opacity),
+				style.strokeWidth * scale, styles);
+			item->setGeometry(record.path);
+			items.append(item);
+		}
+	}
+
+	if (items.isEmpty() && errorString) {
+		*errorString = "The file doesn't contain any supported shapes";
+	}
+	return items;
+}
+
+QList<StrokeItem*> VectorImporter::importClipperTest(const QString& fileName, int testNumber, QString* errorString) {
+	std::ifstream source(QFile::encodeName(fileName).toStdString());
+	if (!source) {
+		if (errorString) *errorString = "Unable to open file: " + fileName;
+		return {};
+	}
+
+	Clipper2Lib::Paths64 subject, subjectOpen, clip;
+	int64_t area = 0, count = 0;
+	Clipper2Lib::ClipType clipType = Clipper2Lib::ClipType::Intersection;
+	Clipper2Lib::FillRule fillRule = Clipper2Lib::FillRule::NonZero;
+	if (!LoadTestNum(source, testNumber, subject, subjectOpen, clip, area, count, clipType, fillRule)) {
+		if (errorString) *errorString = QString("Test %1 was not found in the file").arg(testNumber);
+		return {};
+	}
+
+	// Positive and negative fills have no Qt equivalent, non-zero is the closest
+	const Qt::FillRule qtFillRule = fillRule == Clipper2Lib::FillRule::EvenOdd ? Qt::OddEvenFill : Qt::WindingFill;
+
+	QPainterPath subjectPath = clipperPathsToPainterPath(subject, true);
+	QPainterPath subjectOpenPath = clipperPathsToPainterPath(subjectOpen, false);
+	QPainterPath clipPath = clipperPathsToPainterPath(clip, true);
+
+	// Test coordinates have no relation to the scene, so the test is centered on the origin
+	const QPointF offset = -(subjectPath.boundingRect() | subjectOpenPath.boundingRect() | clipPath.boundingRect()).center();
+
+	const std::shared_ptr<StrokeStyleTable> styles = StrokeStyleTable::forScene(nullptr);
+	QList<StrokeItem*> items;
+	auto addFilled = [&](QPainterPath path, const QColor& color) {
+		if (path.isEmpty()) return;
+		path.translate(offset);
+		path.setFillRule(qtFillRule);
+		StrokeItem* item = new StrokeItem(color, 0, styles);
+		item->setGeometry(path);
+		item->setOutlined(true);
+		items.append(item);
+	};
+
+	addFilled(subjectPath, QColor(0, 0, 156, 64));
+	addFilled(clipPath, QColor(156, 0, 0, 64));
+	if (!subjectOpenPath.isEmpty()) {
+		subjectOpenPath.translate(offset);
+		StrokeItem* item = new StrokeItem(QColor(0, 0, 156), 1.0, styles);
+		item->setGeometry(subjectOpenPath);
+		items.append(item);
+	}
+
+	if (items.isEmpty() && errorString) {
+		*errorString = QString("Test %1 doesn't contain any paths").arg(testNumber);
+	}
+	return items;
+}
\ No newline at end of file
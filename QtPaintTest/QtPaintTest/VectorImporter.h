@@ -0,0 +1,22 @@
+#pragma once
+#include <QtWidgets>
+#include "StrokeItem.h"
+
+// Turns vector files from other tools into StrokeItems that are ready to be
+// added to a scene. Filled shapes become outlined (filled) items, shapes that
+// are only stroked become regular strokes.
+class VectorImporter {
+public:
+	// Supports path, rect, circle, ellipse, line, polyline and polygon elements,
+	// group transforms and fill/stroke styles from attributes, style attributes
+	// and class selectors. Path data is parsed in parallel.
+	static QList<StrokeItem*> importSvg(const QString& fileName, QString* errorString = nullptr);
+
+	// Loads one test from a Clipper test file. The subject and clip paths become
+	// one filled item each, centered on the origin.
+	static QList<StrokeItem*> importClipperTest(const QString& fileName, int testNumber, QString* errorString = nullptr);
+
+	// Parses the "d" attribute of an SVG path. Parsing stops at the first error,
+	// keeping what was read up to that point, the same way browsers do.
+	static QPainterPath parsePathData(QStringView data);
+};
\ No newline at end of file
@@ -1,7 +1,22 @@
 #include <QtWidgets>
 #include "MainWindow.h"
+#include "HeadlessRenderer.h"
+#include "GeometryBenchmark.h"
 
 int main(int argc, char* argv[]) {
+    if (HeadlessRenderer::isRequested(argc, argv)) {
+        // No windows are shown, so no display is needed
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+        QApplication app(argc, argv);
+        return HeadlessRenderer::run(app.arguments());
+    }
+
+    if (GeometryBenchmark::isRequested(argc, argv)) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+        QApplication app(argc, argv);
+        return GeometryBenchmark::run(app.arguments());
+    }
+
     QApplication app(argc, argv);
     MainWindow win;
     win.setWindowTitle("Qt Vector Drawing - Untitled");